@@ -0,0 +1,148 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#include "OfflineRenderer.h"
+
+#include <iostream>
+
+namespace {
+    constexpr auto usage = R"(usage: zlinflator_render [options] <input files...>
+
+renders WAV, AIFF and FLAC files through ZLInflator, several files at once,
+or one file after another split into chunks that are rendered at once
+
+options:
+  --output <dir>          where the rendered files go, next to the inputs by default,
+                          a file that would overwrite its input is not rendered
+  --state <file>          a state blob saved by the plugin, applied before the parameters
+  --param <id>=<value>    set a parameter in its own units, e.g. --param wet=80, repeatable
+  --jobs <n>              how many files or chunks are rendered at once, the number of cores by default
+  --chunk <seconds>       split each file into chunks of that length, for long files
+  --preroll <seconds>     the audio fed before each chunk to settle the filters, 1 by default
+  --block <n>             the block size, 512 by default
+  --double                process in double precision
+)";
+
+    struct Options {
+        zlrender::RenderSettings settings;
+        juce::File outputDirectory;
+        int numJobs = juce::SystemStats::getNumCpus();
+        juce::Array<juce::File> inputs;
+    };
+
+    /** returns an error message, empty on success */
+    juce::String parseArguments(const juce::StringArray &args, Options &options) {
+        for (int i = 0; i < args.size(); ++i) {
+            const auto &arg = args[i];
+            const auto hasValue = i + 1 < args.size();
+            if (arg == "--output" && hasValue) {
+                options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+            } else if (arg == "--state" && hasValue) {
+                const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+                if (!file.loadFileAsData(options.settings.state)) {
+                    return "cannot read the state " + file.getFullPathName();
+                }
+            } else if (arg == "--param" && hasValue) {
+                const auto param = args[++i];
+                if (!param.containsChar('=')) {
+                    return "expected <id>=<value>, got " + param;
+                }
+                options.settings.parameters.emplace_back(param.upToFirstOccurrenceOf("=", false, false),
+                                                         param.fromFirstOccurrenceOf("=", false, false).getFloatValue());
+            } else if (arg == "--jobs" && hasValue) {
+                options.numJobs = juce::jmax(1, args[++i].getIntValue());
+            } else if (arg == "--chunk" && hasValue) {
+                options.settings.chunkSeconds = juce::jmax(0.0, args[++i].getDoubleValue());
+            } else if (arg == "--preroll" && hasValue) {
+                options.settings.preRollSeconds = juce::jmax(0.0, args[++i].getDoubleValue());
+            } else if (arg == "--block" && hasValue) {
+                options.settings.blockSize = juce::jmax(1, args[++i].getIntValue());
+            } else if (arg == "--double") {
+                options.settings.doublePrecision = true;
+            } else if (arg.startsWith("--")) {
+                return "unknown option " + arg;
+            } else {
+                options.inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+            }
+        }
+        if (options.inputs.isEmpty()) {
+            return "no input files";
+        }
+        return {};
+    }
+
+    juce::File getOutputFile(const Options &options, const juce::File &input) {
+        if (options.outputDirectory == juce::File()) {
+            return input.getSiblingFile(input.getFileNameWithoutExtension() + "_inflated" + input.getFileExtension());
+        }
+        return options.outputDirectory.getChildFile(input.getFileName());
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i) {
+        args.add(juce::CharPointer_UTF8(argv[i]));
+    }
+    Options options;
+    if (const auto error = parseArguments(args, options); error.isNotEmpty()) {
+        std::cerr << error << "\n\n" << usage;
+        return 1;
+    }
+    if (options.outputDirectory != juce::File()) {
+        options.outputDirectory.createDirectory();
+    }
+
+    // the file or chunk jobs run on the pool, the encoders on a shared writer thread
+    juce::TimeSliceThread writerThread("zlinflator_render writer");
+    writerThread.startThread();
+    std::vector<zlrender::RenderResult> results(static_cast<size_t>(options.inputs.size()));
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+    if (options.settings.chunkSeconds > 0.0) {
+        juce::ThreadPool pool(options.numJobs);
+        for (int i = 0; i < options.inputs.size(); ++i) {
+            const auto &input = options.inputs.getReference(i);
+            auto &result = results[static_cast<size_t>(i)];
+            result = zlrender::renderFile(input, getOutputFile(options, input), options.settings, writerThread, &pool);
+            std::cout << result.getDescription() << std::endl;
+        }
+    } else {
+        juce::ThreadPool pool(juce::jmin(options.numJobs, options.inputs.size()));
+        juce::CriticalSection reportLock;
+        for (int i = 0; i < options.inputs.size(); ++i) {
+            pool.addJob([&, i] {
+                const auto &input = options.inputs.getReference(i);
+                auto &result = results[static_cast<size_t>(i)];
+                result = zlrender::renderFile(input, getOutputFile(options, input), options.settings, writerThread);
+                const juce::ScopedLock lock(reportLock);
+                std::cout << result.getDescription() << std::endl;
+            });
+        }
+        while (pool.getNumJobs() > 0) {
+            juce::Thread::sleep(10);
+        }
+    }
+    writerThread.stopThread(1000);
+
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    double audioSeconds = 0.0;
+    int numFailed = 0;
+    for (const auto &result: results) {
+        audioSeconds += result.audioSeconds;
+        numFailed += result.ok ? 0 : 1;
+    }
+    std::cout << results.size() << " files, " << numFailed << " failed, "
+              << juce::String(audioSeconds / wallSeconds, 1) << "x realtime overall" << std::endl;
+    return numFailed == 0 ? 0 : 1;
+}
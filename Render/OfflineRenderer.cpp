@@ -0,0 +1,271 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#include "OfflineRenderer.h"
+
+namespace zlrender {
+    namespace {
+        // about 0.7 s at 48 kHz, written while the next blocks are processed
+        constexpr int writerBufferSize = 32768;
+
+        std::unique_ptr<juce::AudioFormatReader> createReader(juce::AudioFormat &format, const juce::File &file) {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format.createMemoryMappedReader(file));
+            if (mapped != nullptr && mapped->mapEntireFile()) {
+                return mapped;
+            }
+            // FLAC and other compressed formats are decoded from a stream
+            return std::unique_ptr<juce::AudioFormatReader>(format.createReaderFor(file.createInputStream().release(),
+                                                                                   true));
+        }
+
+        std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormat &format, const juce::File &file,
+                                                              const juce::AudioFormatReader &reader) {
+            auto stream = file.createOutputStream();
+            if (stream == nullptr) {
+                return nullptr;
+            }
+            // keep the bit depth of the input, or the closest one the format can write
+            auto bitDepth = static_cast<int>(reader.bitsPerSample);
+            const auto depths = format.getPossibleBitDepths();
+            if (!depths.contains(bitDepth) && !depths.isEmpty()) {
+                bitDepth = depths.getLast();
+            }
+            std::unique_ptr<juce::AudioFormatWriter> writer(
+                    format.createWriterFor(stream.get(), reader.sampleRate, reader.numChannels, bitDepth,
+                                           reader.metadataValues, 0));
+            if (writer != nullptr) {
+                // the writer owns the stream now
+                juce::ignoreUnused(stream.release());
+            }
+            return writer;
+        }
+    }
+
+    juce::String RenderResult::getDescription() const {
+        if (!ok) {
+            return input.getFileName() + ": " + error;
+        }
+        return input.getFileName() + " -> " + output.getFullPathName() + ": "
+               + juce::String(audioSeconds, 1) + " s in " + juce::String(renderSeconds, 2) + " s, "
+               + juce::String(getRealtimeFactor(), 1) + "x realtime";
+    }
+
+    juce::String prepareProcessor(ZLInflatorAudioProcessor &processor, const RenderSettings &settings,
+                                  int numChannels, double sampleRate) {
+        const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels).isDisabled()
+                                ? juce::AudioChannelSet::discreteChannels(numChannels)
+                                : juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(channelSet);
+        layout.outputBuses.add(channelSet);
+        if (!processor.setBusesLayout(layout)) {
+            return "unsupported number of channels: " + juce::String(numChannels);
+        }
+        // non-realtime first, so that the state and the parameters reach the shapers at once on this thread
+        processor.setNonRealtime(true);
+        if (settings.state.getSize() > 0) {
+            processor.setStateInformation(settings.state.getData(), static_cast<int>(settings.state.getSize()));
+        }
+        for (const auto &[ID, value]: settings.parameters) {
+            auto *parameter = processor.parameters.getParameter(ID);
+            if (parameter == nullptr) {
+                return "unknown parameter: " + ID;
+            }
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+        // the oversamplers are built in prepareToPlay, so everything they depend on is set before it
+        processor.setProcessingPrecision(settings.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                  : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails(sampleRate, settings.blockSize);
+        processor.prepareToPlay(sampleRate, settings.blockSize);
+        return {};
+    }
+
+    namespace {
+        /**
+         * feed the input from feedStart and pass the output of [outputStart, outputEnd) to consumer
+         * as (buffer, startSample, numSamples, outputPosition), the input past its end is silence
+         */
+        template<typename Consumer>
+        void processRange(ZLInflatorAudioProcessor &processor, juce::AudioFormatReader &reader,
+                          const RenderSettings &settings, juce::int64 feedStart,
+                          juce::int64 outputStart, juce::int64 outputEnd, Consumer &&consumer) {
+            // buffer sample i holds the output for input sample position + i - latency
+            const auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+            const auto numChannels = static_cast<int>(reader.numChannels);
+            juce::AudioBuffer<float> buffer(numChannels, settings.blockSize);
+            juce::AudioBuffer<double> doubleBuffer(settings.doublePrecision ? numChannels : 0, settings.blockSize);
+            juce::MidiBuffer midi;
+            for (auto position = feedStart; position < outputEnd + latency; position += settings.blockSize) {
+                const auto blockSize = static_cast<int>(juce::jmin(static_cast<juce::int64>(settings.blockSize),
+                                                                   outputEnd + latency - position));
+                buffer.setSize(numChannels, blockSize, false, false, true);
+                buffer.clear();
+                if (position < reader.lengthInSamples) {
+                    const auto numRead = static_cast<int>(juce::jmin(static_cast<juce::int64>(blockSize),
+                                                                     reader.lengthInSamples - position));
+                    reader.read(&buffer, 0, numRead, position, true, true);
+                }
+                if (settings.doublePrecision) {
+                    doubleBuffer.makeCopyOf(buffer, true);
+                    processor.processBlock(doubleBuffer, midi);
+                    buffer.makeCopyOf(doubleBuffer, true);
+                } else {
+                    processor.processBlock(buffer, midi);
+                }
+                const auto first = juce::jmax(outputStart, position - latency);
+                const auto last = juce::jmin(outputEnd, position - latency + blockSize);
+                if (first < last) {
+                    consumer(buffer, static_cast<int>(first - (position - latency)), static_cast<int>(last - first),
+                             first);
+                }
+            }
+        }
+
+        /** render the output samples [start, start + length) of a file with a fresh processor */
+        juce::String renderChunk(juce::AudioFormat &format, const juce::File &input, const RenderSettings &settings,
+                                 juce::int64 start, juce::int64 length, juce::AudioBuffer<float> &output) {
+            const auto reader = createReader(format, input);
+            if (reader == nullptr) {
+                return "cannot read the file";
+            }
+            ZLInflatorAudioProcessor processor;
+            if (auto error = prepareProcessor(processor, settings, static_cast<int>(reader->numChannels),
+                                              reader->sampleRate); error.isNotEmpty()) {
+                return error;
+            }
+            output.setSize(static_cast<int>(reader->numChannels), static_cast<int>(length), false, false, true);
+            const auto preRoll = static_cast<juce::int64>(settings.preRollSeconds * reader->sampleRate);
+            processRange(processor, *reader, settings, juce::jmax(static_cast<juce::int64>(0), start - preRoll),
+                         start, start + length,
+                         [&](const juce::AudioBuffer<float> &buffer, int startSample, int numSamples,
+                             juce::int64 position) {
+                             for (int ch = 0; ch < output.getNumChannels(); ++ch) {
+                                 output.copyFrom(ch, static_cast<int>(position - start), buffer, ch, startSample,
+                                                 numSamples);
+                             }
+                         });
+            return {};
+        }
+
+        void write(juce::AudioFormatWriter::ThreadedWriter &writer, const juce::AudioBuffer<float> &buffer,
+                   int startSample, int numSamples) {
+            std::array<const float *, WaveShaper<float>::maxChannels> channels{};
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+                channels[static_cast<size_t>(ch)] = buffer.getReadPointer(ch, startSample);
+            }
+            // the writer thread is behind, wait for it to free some of its buffer
+            while (!writer.write(channels.data(), numSamples)) {
+                juce::Thread::sleep(1);
+            }
+        }
+
+        /**
+         * the chunks are rendered in batches of one per pool thread and written in order
+         * so at most one batch of chunks is held in memory
+         */
+        juce::String renderChunks(juce::AudioFormat &format, const juce::File &input, const RenderSettings &settings,
+                                  juce::int64 numSamples, double sampleRate, juce::ThreadPool &pool,
+                                  juce::AudioFormatWriter::ThreadedWriter &writer) {
+            const auto chunkLength = juce::jmax(static_cast<juce::int64>(settings.blockSize),
+                                                static_cast<juce::int64>(settings.chunkSeconds * sampleRate));
+            const auto numChunks = (numSamples + chunkLength - 1) / chunkLength;
+            const auto batchSize = static_cast<juce::int64>(juce::jmax(1, pool.getNumThreads()));
+            std::vector<juce::AudioBuffer<float>> outputs(static_cast<size_t>(juce::jmin(batchSize, numChunks)));
+            std::vector<juce::String> errors(outputs.size());
+            for (juce::int64 firstChunk = 0; firstChunk < numChunks; firstChunk += batchSize) {
+                const auto numJobs = static_cast<size_t>(juce::jmin(batchSize, numChunks - firstChunk));
+                std::atomic<size_t> remaining{numJobs};
+                juce::WaitableEvent done;
+                for (size_t i = 0; i < numJobs; ++i) {
+                    pool.addJob([&, i] {
+                        const auto start = (firstChunk + static_cast<juce::int64>(i)) * chunkLength;
+                        errors[i] = renderChunk(format, input, settings, start,
+                                                juce::jmin(chunkLength, numSamples - start), outputs[i]);
+                        if (remaining.fetch_sub(1) == 1) {
+                            done.signal();
+                        }
+                    });
+                }
+                done.wait();
+                for (size_t i = 0; i < numJobs; ++i) {
+                    if (errors[i].isNotEmpty()) {
+                        return errors[i];
+                    }
+                    write(writer, outputs[i], 0, outputs[i].getNumSamples());
+                }
+            }
+            return {};
+        }
+    }
+
+    RenderResult renderFile(const juce::File &input, const juce::File &output, const RenderSettings &settings,
+                            juce::TimeSliceThread &writerThread, juce::ThreadPool *chunkPool) {
+        RenderResult result{input, output};
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+        auto *format = formatManager.findFormatForFileExtension(input.getFileExtension());
+        if (format == nullptr) {
+            result.error = "unsupported file format";
+            return result;
+        }
+        if (output == input) {
+            result.error = "the output would overwrite the input";
+            return result;
+        }
+        const auto reader = createReader(*format, input);
+        if (reader == nullptr) {
+            result.error = "cannot read the file";
+            return result;
+        }
+        // render into a temporary file next to the output, it only replaces the output once the render succeeded
+        juce::TemporaryFile temporary(output);
+        auto writer = createWriter(*format, temporary.getFile(), *reader);
+        if (writer == nullptr) {
+            result.error = "cannot write " + output.getFullPathName();
+            return result;
+        }
+
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+        {
+            juce::AudioFormatWriter::ThreadedWriter threadedWriter(writer.release(), writerThread, writerBufferSize);
+            if (chunkPool != nullptr && settings.chunkSeconds > 0.0) {
+                result.error = renderChunks(*format, input, settings, reader->lengthInSamples, reader->sampleRate,
+                                            *chunkPool, threadedWriter);
+            } else {
+                ZLInflatorAudioProcessor processor;
+                result.error = prepareProcessor(processor, settings, static_cast<int>(reader->numChannels),
+                                                reader->sampleRate);
+                if (result.error.isEmpty()) {
+                    processRange(processor, *reader, settings, 0, 0, reader->lengthInSamples,
+                                 [&](const juce::AudioBuffer<float> &buffer, int startSample, int numSamples,
+                                     juce::int64) {
+                                     write(threadedWriter, buffer, startSample, numSamples);
+                                 });
+                }
+            }
+            // the rest of the buffer is flushed when the threaded writer goes out of scope
+        }
+        if (result.error.isNotEmpty()) {
+            return result;
+        }
+        if (!temporary.overwriteTargetFileWithTemporary()) {
+            result.error = "cannot write " + output.getFullPathName();
+            return result;
+        }
+        result.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        result.audioSeconds = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+        result.ok = true;
+        return result;
+    }
+}
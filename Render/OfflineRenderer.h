@@ -0,0 +1,68 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#ifndef ZLINFLATOR_OFFLINERENDERER_H
+#define ZLINFLATOR_OFFLINERENDERER_H
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "PluginProcessor.h"
+
+namespace zlrender {
+    struct RenderSettings {
+        // a blob saved by getStateInformation, applied first when not empty
+        juce::MemoryBlock state;
+        // parameter IDs and values in the units of the parameter, e.g. {"wet", 80}
+        std::vector<std::pair<juce::String, float>> parameters;
+        int blockSize = 512;
+        bool doublePrecision = false;
+        // when above zero and a pool is given, a file is split into chunks of that length, rendered in parallel
+        double chunkSeconds = 0.0;
+        // fed before each chunk and thrown away, so that the filters have settled when the chunk starts
+        double preRollSeconds = 1.0;
+    };
+
+    struct RenderResult {
+        juce::File input, output;
+        bool ok = false;
+        juce::String error;
+        double audioSeconds = 0.0, renderSeconds = 0.0;
+
+        double getRealtimeFactor() const {
+            return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0;
+        }
+
+        /** one line for the job report */
+        juce::String getDescription() const;
+    };
+
+    /**
+     * set the layout, the precision, the state and the parameters, then prepare the processor for an offline render
+     * returns an error message, empty on success
+     */
+    juce::String prepareProcessor(ZLInflatorAudioProcessor &processor, const RenderSettings &settings,
+                                  int numChannels, double sampleRate);
+
+    /**
+     * render a whole file through a processor with no editor, the output has the format of the input
+     * the output is written to a temporary file that replaces it at the end, an output equal to the input is refused
+     * the input is memory-mapped when the format allows it (WAV, AIFF), the output is written on writerThread
+     * the latency of the processor is removed, so the output lines up with the input
+     * with chunkPool and settings.chunkSeconds, the chunks of the file are rendered on the pool, each by its own
+     * processor after a pre-roll, the crossover and IIR filters never fully forget, so the joins differ from
+     * a single-threaded render by the decayed filter state, far below the resolution of 24-bit output
+     */
+    RenderResult renderFile(const juce::File &input, const juce::File &output, const RenderSettings &settings,
+                            juce::TimeSliceThread &writerThread, juce::ThreadPool *chunkPool = nullptr);
+}
+
+#endif //ZLINFLATOR_OFFLINERENDERER_H
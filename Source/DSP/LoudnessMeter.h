@@ -0,0 +1,280 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#ifndef ZLINFLATOR_LOUDNESSMETER_H
+#define ZLINFLATOR_LOUDNESSMETER_H
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace zldsp {
+    /**
+     * ITU-R BS.1770-4 / EBU R 128 loudness: momentary, short-term, integrated and loudness range (EBU Tech 3342)
+     * the K-weighted energy is summed into 100 ms sub-blocks, a ring buffer of them gives the sliding windows
+     * the gated measurements keep histograms with 0.1 LU bins, so the memory does not grow with the duration
+     * the results are atomics, which any thread may read while the audio thread measures
+     * every channel has weight 1, as the layout does not tell which channels are surround or LFE
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class LoudnessMeter {
+    public:
+        void prepare(const juce::dsp::ProcessSpec &spec) {
+            states.resize(spec.numChannels);
+            subBlockLength = juce::jmax(static_cast<size_t>(1), static_cast<size_t>(std::round(spec.sampleRate * 0.1)));
+            setCoefficients(spec.sampleRate);
+            reset();
+        }
+
+        /** clear every measurement, call it when the audio thread is not running */
+        void reset() {
+            std::fill(states.begin(), states.end(), FilterState{});
+            subBlocks.fill(0.0);
+            numSubBlocks = 0;
+            subBlockPos = 0;
+            subBlockEnergy = 0.0;
+            momentaryHistogram.reset();
+            shortTermHistogram.reset();
+            for (auto *v: {&momentary, &shortTerm, &integrated}) {
+                v->store(minLoudness, std::memory_order_relaxed);
+            }
+            loudnessRange.store(0, std::memory_order_relaxed);
+        }
+
+        /** ask the audio thread to restart the integrated loudness and the loudness range */
+        void requestReset() {
+            toReset.store(true, std::memory_order_release);
+        }
+
+        template<typename BlockType>
+        void process(const BlockType &block) noexcept {
+            if (toReset.exchange(false, std::memory_order_acquire)) {
+                reset();
+            }
+            const auto numChannels = juce::jmin(block.getNumChannels(), states.size());
+            const auto numSamples = block.getNumSamples();
+            for (size_t start = 0; start < numSamples;) {
+                const auto length = juce::jmin(numSamples - start, subBlockLength - subBlockPos);
+                for (size_t ch = 0; ch < numChannels; ++ch) {
+                    subBlockEnergy += filter(states[ch], block.getChannelPointer(ch) + start, length);
+                }
+                start += length;
+                subBlockPos += length;
+                if (subBlockPos == subBlockLength) {
+                    finishSubBlock();
+                }
+            }
+        }
+
+        FloatType getMomentary() const { return momentary.load(std::memory_order_relaxed); }
+
+        FloatType getShortTerm() const { return shortTerm.load(std::memory_order_relaxed); }
+
+        FloatType getIntegrated() const { return integrated.load(std::memory_order_relaxed); }
+
+        FloatType getLoudnessRange() const { return loudnessRange.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr FloatType minLoudness = FloatType(-100);
+        static constexpr size_t momentaryLength = 4, shortTermLength = 30;
+        static constexpr double absoluteGate = -70.0;
+
+        struct Biquad {
+            double b0{}, b1{}, b2{}, a1{}, a2{};
+        };
+
+        struct FilterState {
+            double s1{}, s2{}, s3{}, s4{};
+        };
+
+        /** gated blocks by loudness, from the absolute gate up to +10 LUFS */
+        class Histogram {
+        public:
+            static constexpr size_t numBins = 800;
+
+            void reset() {
+                counts.fill(0);
+                energies.fill(0.0);
+                total = 0;
+                totalEnergy = 0.0;
+            }
+
+            void add(double energy) {
+                const auto loudness = toLoudness(energy);
+                if (loudness < absoluteGate) {
+                    return;
+                }
+                const auto bin = juce::jmin(numBins - 1, static_cast<size_t>((loudness - absoluteGate) * 10.0));
+                counts[bin] += 1;
+                energies[bin] += energy;
+                total += 1;
+                totalEnergy += energy;
+            }
+
+            /** the first bin at or above the gate relative to the mean of the blocks above the absolute gate */
+            size_t getRelativeGateBin(double relativeGate) const {
+                const auto gate = toLoudness(totalEnergy / static_cast<double>(total)) + relativeGate;
+                return static_cast<size_t>(juce::jlimit(0.0, static_cast<double>(numBins),
+                                                        std::ceil((gate - absoluteGate) * 10.0)));
+            }
+
+            static double getBinLoudness(size_t bin) {
+                return absoluteGate + (static_cast<double>(bin) + 0.5) * 0.1;
+            }
+
+            std::array<size_t, numBins> counts{};
+            std::array<double, numBins> energies{};
+            size_t total = 0;
+            double totalEnergy = 0.0;
+        };
+
+        Biquad shelf, highPass;
+        std::vector<FilterState> states;
+
+        size_t subBlockLength = 4800, subBlockPos = 0;
+        double subBlockEnergy = 0.0;
+        // the mean square of the latest sub-blocks, summed over the channels
+        std::array<double, shortTermLength> subBlocks{};
+        size_t numSubBlocks = 0;
+
+        Histogram momentaryHistogram, shortTermHistogram;
+
+        std::atomic<FloatType> momentary{minLoudness}, shortTerm{minLoudness}, integrated{minLoudness};
+        std::atomic<FloatType> loudnessRange{0};
+        std::atomic<bool> toReset{false};
+
+        static double toLoudness(double energy) {
+            return energy > 0.0 ? juce::jmax(-0.691 + 10.0 * std::log10(energy), static_cast<double>(minLoudness))
+                                : static_cast<double>(minLoudness);
+        }
+
+        /** the K-weighting pre-filter and RLB high-pass of BS.1770, at any sample rate */
+        void setCoefficients(double sampleRate) {
+            {
+                const auto k = std::tan(juce::MathConstants<double>::pi * 1681.974450955533 / sampleRate);
+                const auto q = 0.7071752369554196;
+                const auto vh = std::pow(10.0, 3.999843853973347 / 20.0);
+                const auto vb = std::pow(vh, 0.4996667741545416);
+                const auto a0 = 1.0 + k / q + k * k;
+                shelf = {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+                         2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+            }
+            {
+                const auto k = std::tan(juce::MathConstants<double>::pi * 38.13547087602444 / sampleRate);
+                const auto q = 0.5003270373238773;
+                const auto a0 = 1.0 + k / q + k * k;
+                highPass = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+            }
+        }
+
+        /** K-weight one channel, returns the sum of squares */
+        template<typename T>
+        double filter(FilterState &state, const T *data, size_t numSamples) const noexcept {
+            auto s = state;
+            double sum = 0.0;
+            for (size_t i = 0; i < numSamples; ++i) {
+                const auto x = static_cast<double>(data[i]);
+                const auto y = shelf.b0 * x + s.s1;
+                s.s1 = shelf.b1 * x - shelf.a1 * y + s.s2;
+                s.s2 = shelf.b2 * x - shelf.a2 * y;
+                const auto z = highPass.b0 * y + s.s3;
+                s.s3 = highPass.b1 * y - highPass.a1 * z + s.s4;
+                s.s4 = highPass.b2 * y - highPass.a2 * z;
+                sum += z * z;
+            }
+            state = s;
+            return sum;
+        }
+
+        double getWindowEnergy(size_t length) const {
+            double sum = 0.0;
+            for (size_t i = 0; i < length; ++i) {
+                sum += subBlocks[(numSubBlocks + shortTermLength - 1 - i) % shortTermLength];
+            }
+            return sum / static_cast<double>(length);
+        }
+
+        void finishSubBlock() {
+            subBlocks[numSubBlocks % shortTermLength] = subBlockEnergy / static_cast<double>(subBlockLength);
+            numSubBlocks += 1;
+            subBlockPos = 0;
+            subBlockEnergy = 0.0;
+            // before a window is full, the missing sub-blocks count as silence
+            const auto momentaryEnergy = getWindowEnergy(momentaryLength);
+            const auto shortTermEnergy = getWindowEnergy(shortTermLength);
+            momentary.store(static_cast<FloatType>(toLoudness(momentaryEnergy)), std::memory_order_relaxed);
+            shortTerm.store(static_cast<FloatType>(toLoudness(shortTermEnergy)), std::memory_order_relaxed);
+            // gating blocks of 400 ms overlap by 75 %, the loudness range uses 3 s windows every 100 ms
+            if (numSubBlocks >= momentaryLength) {
+                momentaryHistogram.add(momentaryEnergy);
+                updateIntegrated();
+            }
+            if (numSubBlocks >= shortTermLength) {
+                shortTermHistogram.add(shortTermEnergy);
+                updateLoudnessRange();
+            }
+        }
+
+        void updateIntegrated() {
+            const auto &h = momentaryHistogram;
+            if (h.total == 0) {
+                return;
+            }
+            size_t count = 0;
+            double energy = 0.0;
+            for (auto bin = h.getRelativeGateBin(-10.0); bin < Histogram::numBins; ++bin) {
+                count += h.counts[bin];
+                energy += h.energies[bin];
+            }
+            if (count > 0) {
+                integrated.store(static_cast<FloatType>(toLoudness(energy / static_cast<double>(count))),
+                                 std::memory_order_relaxed);
+            }
+        }
+
+        void updateLoudnessRange() {
+            const auto &h = shortTermHistogram;
+            if (h.total == 0) {
+                return;
+            }
+            const auto gateBin = h.getRelativeGateBin(-20.0);
+            size_t count = 0;
+            for (auto bin = gateBin; bin < Histogram::numBins; ++bin) {
+                count += h.counts[bin];
+            }
+            if (count == 0) {
+                return;
+            }
+            // the 10th and the 95th percentile of the short-term loudness above the gate
+            const auto lowRank = static_cast<size_t>(0.10 * static_cast<double>(count - 1));
+            const auto highRank = static_cast<size_t>(0.95 * static_cast<double>(count - 1));
+            size_t lowBin = gateBin, highBin = gateBin, seen = 0;
+            for (auto bin = gateBin; bin < Histogram::numBins; ++bin) {
+                if (h.counts[bin] == 0) {
+                    continue;
+                }
+                if (seen <= lowRank) {
+                    lowBin = bin;
+                }
+                if (seen <= highRank) {
+                    highBin = bin;
+                }
+                seen += h.counts[bin];
+            }
+            loudnessRange.store(static_cast<FloatType>(Histogram::getBinLoudness(highBin) -
+                                                       Histogram::getBinLoudness(lowBin)),
+                                std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif //ZLINFLATOR_LOUDNESSMETER_H
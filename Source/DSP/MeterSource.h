@@ -15,11 +15,46 @@ You should have received a copy of the GNU General Public License along with ZLI
 
 #include "juce_audio_processors/juce_audio_processors.h"
 #include "juce_dsp/juce_dsp.h"
+#include "TruePeakDetector.h"
+#include "LoudnessMeter.h"
 
+#include <span>
+
+/**
+ * block levels of every channel, sent as linear gains from the audio thread to the GUI thread
+ * through a lock-free FIFO of frames, the GUI thread converts them to dB
+ * @tparam FloatType
+ */
 template<typename FloatType>
 class MeterSource
 {
 public:
+    static constexpr size_t maxChannels = 16;
+
+    /** the largest RMS and peak of every channel over one or more blocks, linear gains */
+    struct Frame {
+        std::array<FloatType, maxChannels> rms{}, peak{};
+
+        void merge(const Frame &other) noexcept {
+            for (size_t i = 0; i < maxChannels; ++i) {
+                rms[i] = juce::jmax(rms[i], other.rms[i]);
+                peak[i] = juce::jmax(peak[i], other.peak[i]);
+            }
+        }
+    };
+
+    /** what the meters show, in dB, preallocated and owned by the GUI thread */
+    struct DisplayState {
+        std::array<FloatType, maxChannels> rms{}, peak{}, peakMax{};
+        size_t numChannels = 0;
+
+        std::span<const FloatType> getRMS() const { return {rms.data(), numChannels}; }
+
+        std::span<const FloatType> getPeak() const { return {peak.data(), numChannels}; }
+
+        std::span<const FloatType> getPeakMax() const { return {peakMax.data(), numChannels}; }
+    };
+
     void reset() noexcept {}
 
     template<typename SampleType>
@@ -31,120 +66,194 @@ public:
     void process(const ProcessContext &context) noexcept {
         if (context.usesSeparateInputAndOutputBlocks())
             context.getOutputBlock().copyFrom(context.getInputBlock());
-        if (lock) {
+        const auto numSamples = context.getInputBlock().getNumSamples();
+        const auto numChannels = juce::jmin(context.getInputBlock().getNumChannels(),
+                                            sourceChannels.load(std::memory_order_relaxed));
+        if (numSamples == 0) {
             return;
         }
-        const auto numSamples = context.getInputBlock().getNumSamples();
-        const auto numChannels = context.getInputBlock().getNumChannels();
+        // the interpolator history is stale after a pause, so it restarts whenever true peak is turned on
+        const auto truePeak = truePeakFlag.load(std::memory_order_relaxed);
+        if (truePeak && !truePeakActive) {
+            truePeakDetector.reset();
+        }
+        truePeakActive = truePeak;
         auto block = context.getInputBlock();
         for (size_t i = 0; i < numChannels; ++i) {
-            auto currentRMS = juce::Decibels::gainToDecibels(getRMSLevel(block, i, 0, numSamples));
-            auto currentPeak = juce::Decibels::gainToDecibels(getPeakLevel(block, i, 0, numSamples));
-            bufferRMS[i] = juce::jmax(bufferRMS[i], currentRMS);
-            bufferPeak[i] = juce::jmax(bufferPeak[i], currentPeak);
-            peakMax[i] = juce::jmax(currentPeak, peakMax[i]);
+            const auto *data = block.getChannelPointer(i);
+            const auto levels = getLevels(data, numSamples);
+            // the levels are kept in FloatType, whatever the precision of the block
+            const auto currentRMS = static_cast<FloatType>(std::sqrt(levels.sumSquares /
+                                                                     static_cast<double>(numSamples)));
+            auto currentPeak = static_cast<FloatType>(levels.peak);
+            if (truePeak) {
+                currentPeak = juce::jmax(currentPeak, truePeakDetector.process(i, data, numSamples));
+            }
+            pending.rms[i] = juce::jmax(pending.rms[i], currentRMS);
+            pending.peak[i] = juce::jmax(pending.peak[i], currentPeak);
+        }
+        pushPending();
+        const auto loudness = loudnessFlag.load(std::memory_order_relaxed);
+        if (loudness && !loudnessActive) {
+            loudnessMeter.reset();
+        }
+        loudnessActive = loudness;
+        if (loudness) {
+            loudnessMeter.process(block.getSubsetChannelBlock(0, numChannels));
         }
     }
 
     void prepare(const juce::dsp::ProcessSpec &spec) {
+        jassert(spec.numChannels <= maxChannels);
+        const auto numChannels = juce::jmin(static_cast<size_t>(spec.numChannels), maxChannels);
+        sourceChannels.store(numChannels, std::memory_order_relaxed);
+        truePeakDetector.prepare(numChannels);
+        loudnessMeter.prepare({spec.sampleRate, spec.maximumBlockSize, static_cast<juce::uint32>(numChannels)});
+        pending = Frame{};
+    }
 
-        for (auto f: {&peakMax, &bufferRMS, &bufferPeak, &displayRMS, &displayPeak}) {
-            (*f).resize(spec.numChannels);
+    /**
+     * read every frame sent since the last call and update the display state, GUI thread only
+     */
+    const DisplayState &updateDisplay() noexcept {
+        const auto numChannels = sourceChannels.load(std::memory_order_relaxed);
+        if (numChannels != display.numChannels) {
+            display.numChannels = numChannels;
+            display.rms.fill(minDB);
+            display.peak.fill(minDB);
+            display.peakMax.fill(minDB);
         }
-        resetPeakMax();
-        resetBuffer();
-        for (size_t i = 0; i < displayRMS.size(); ++i) {
-            displayRMS[i] = static_cast<FloatType>(-100);
-            displayPeak[i] = static_cast<FloatType>(-100);
+        Frame levels;
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+        for (auto i = start1; i < start1 + size1; ++i) {
+            levels.merge(frames[static_cast<size_t>(i)]);
         }
-    }
-
-    std::vector<FloatType> getDisplayRMS() {
-        for (size_t i = 0; i < displayRMS.size(); ++i) {
-            displayRMS[i] = juce::jmax(displayRMS[i] - static_cast<FloatType>(decayRate), bufferRMS[i]);
+        for (auto i = start2; i < start2 + size2; ++i) {
+            levels.merge(frames[static_cast<size_t>(i)]);
         }
-        return displayRMS;
-    }
-
-    std::vector<FloatType> getDisplayPeak() {
-        for (size_t i = 0; i < displayPeak.size(); ++i) {
-            displayPeak[i] = juce::jmax(displayPeak[i] - static_cast<FloatType>(decayRate), bufferPeak[i]);
+        fifo.finishedRead(size1 + size2);
+        const auto decay = static_cast<FloatType>(decayRate);
+        for (size_t i = 0; i < numChannels; ++i) {
+            const auto peak = toDecibels(levels.peak[i]);
+            display.rms[i] = juce::jmax(display.rms[i] - decay, toDecibels(levels.rms[i]));
+            display.peak[i] = juce::jmax(display.peak[i] - decay, peak);
+            display.peakMax[i] = juce::jmax(display.peakMax[i], peak);
         }
-        return displayPeak;
+        return display;
     }
 
-    std::vector<FloatType> getPeakMax() {
-        return peakMax;
+    /** GUI thread only */
+    void resetPeakMax() {
+        display.peakMax.fill(minDB);
     }
 
-    void resetBuffer() {
-        lock = true;
-        for (size_t i = 0; i < bufferRMS.size(); ++i) {
-            bufferRMS[i] = static_cast<FloatType>(-100);
-            bufferPeak[i] = static_cast<FloatType>(-100);
-        }
-        lock = false;
+    void setDecayRate(float x) {
+        decayRate = x;
     }
 
-    void resetPeakMax() {
-        lock = true;
-        for (size_t i = 0; i < peakMax.size(); ++i) {
-            peakMax[i] = static_cast<FloatType>(-100);
-        }
-        lock = false;
+    /**
+     * measure the peaks on the 4x oversampled signal (ITU-R BS.1770), off by default
+     */
+    void setTruePeak(bool f) {
+        truePeakFlag.store(f, std::memory_order_relaxed);
     }
 
-    void setDecayRate(float x) {
-        decayRate = x;
+    /**
+     * measure the loudness (LUFS) as well, off by default
+     */
+    void setLoudness(bool f) {
+        loudnessFlag.store(f, std::memory_order_relaxed);
     }
 
-    bool getDataFlag() {
-        return dataFlag;
+    /** the loudness measurements, safe to read from any thread */
+    const zldsp::LoudnessMeter<FloatType> &getLoudnessMeter() const {
+        return loudnessMeter;
     }
 
-    void resetDataFlag() {
-        dataFlag = false;
+    /** restart the integrated loudness and the loudness range */
+    void resetLoudness() {
+        loudnessMeter.requestReset();
     }
 
 private:
-    std::vector<FloatType> peakMax;
-    std::vector<FloatType> bufferRMS, bufferPeak;
-    std::vector<FloatType> displayRMS, displayPeak;
-    std::atomic<bool> lock = false;
+    static constexpr int numFrames = 128;
+    static constexpr FloatType minDB = FloatType(-100);
+
+    // single producer (audio thread), single consumer (GUI thread)
+    juce::AbstractFifo fifo{numFrames};
+    std::array<Frame, numFrames> frames;
+    // the levels not sent yet, while the FIFO is full they keep growing, so no block is lost
+    Frame pending;
+    std::atomic<size_t> sourceChannels{0};
+
+    DisplayState display;
     float decayRate = 0.12f;
-    bool dataFlag = false;
 
-    template<typename T>
-    T getRMSLevel(juce::dsp::AudioBlock<T> block, unsigned long channel, unsigned long startSample,
-                  unsigned long numSamples) const noexcept {
-        if (numSamples <= 0 || channel < 0 || channel >= block.getNumChannels() || block.getNumSamples() == 0)
-            return FloatType(0);
+    zldsp::TruePeakDetector<FloatType> truePeakDetector;
+    std::atomic<bool> truePeakFlag = false;
+    bool truePeakActive = false;
 
-        auto *data = block.getChannelPointer(channel) + startSample;
-        double sum = 0.0;
+    zldsp::LoudnessMeter<FloatType> loudnessMeter;
+    std::atomic<bool> loudnessFlag = false;
+    bool loudnessActive = false;
 
-        for (size_t i = 0; i < numSamples; ++i) {
-            auto sample = data[i];
-            sum += sample * sample;
+    void pushPending() noexcept {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 + size2 == 1) {
+            frames[static_cast<size_t>(size1 == 1 ? start1 : start2)] = pending;
+            fifo.finishedWrite(1);
+            pending = Frame{};
         }
-        return static_cast<FloatType> (std::sqrt(sum / static_cast<double>(numSamples)));
     }
 
-    template<typename T>
-    T getPeakLevel(juce::dsp::AudioBlock<T> block, unsigned long channel, unsigned long startSample,
-                   unsigned long numSamples) const noexcept {
-        if (numSamples <= 0 || channel < 0 || channel >= block.getNumChannels() || block.getNumSamples() == 0)
-            return FloatType(0);
+    static FloatType toDecibels(FloatType gain) {
+        return juce::Decibels::gainToDecibels(gain, minDB);
+    }
+
+    // the SIMD partial sums are flushed into the double sum every chunkSize samples
+    static constexpr size_t chunkSize = 256;
 
-        auto *data = block.getChannelPointer(channel) + startSample;
-        FloatType localPeak = -1000.0;
+    template<typename T>
+    struct Levels {
+        double sumSquares;
+        T peak;
+    };
 
-        for (size_t i = 0; i < numSamples; ++i) {
-            if (data[i] > localPeak) {
-                localPeak = static_cast<FloatType> (data[i]);
+    /**
+     * the sum of squares and the absolute peak of one channel in a single SIMD pass
+     * the sum of squares is kept in double, so that long blocks of float samples do not lose precision
+     */
+    template<typename T>
+    static Levels<T> getLevels(const T *data, size_t numSamples) noexcept {
+        using SIMDType = juce::dsp::SIMDRegister<T>;
+        constexpr auto width = SIMDType::SIMDNumElements;
+        Levels<T> levels{0, 0};
+        size_t i = 0;
+        for (; i < numSamples && !SIMDType::isSIMDAligned(data + i); ++i) {
+            levels.sumSquares += static_cast<double>(data[i]) * static_cast<double>(data[i]);
+            levels.peak = juce::jmax(levels.peak, std::abs(data[i]));
+        }
+        auto peak = SIMDType::expand(0);
+        while (i + width <= numSamples) {
+            const auto chunkEnd = juce::jmin(numSamples, i + chunkSize);
+            auto sumSquares = SIMDType::expand(0);
+            for (; i + width <= chunkEnd; i += width) {
+                const auto x = SIMDType::fromRawArray(data + i);
+                sumSquares += x * x;
+                peak = SIMDType::max(peak, SIMDType::abs(x));
             }
+            levels.sumSquares += static_cast<double>(sumSquares.sum());
+        }
+        for (; i < numSamples; ++i) {
+            levels.sumSquares += static_cast<double>(data[i]) * static_cast<double>(data[i]);
+            levels.peak = juce::jmax(levels.peak, std::abs(data[i]));
+        }
+        for (size_t k = 0; k < width; ++k) {
+            levels.peak = juce::jmax(levels.peak, peak.get(k));
         }
-        return localPeak;
+        return levels;
     }
 };
 
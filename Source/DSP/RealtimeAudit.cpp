@@ -0,0 +1,209 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+#include "RealtimeAudit.h"
+
+#if ZL_REALTIME_AUDIT
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#define ZL_AUDIT_GLIBC_HOOKS 1
+#endif
+
+#if JUCE_GCC || JUCE_CLANG
+// initial-exec keeps the TLS access free of allocations, even inside a shared library
+#define ZL_AUDIT_TLS __attribute__((tls_model("initial-exec")))
+#else
+#define ZL_AUDIT_TLS
+#endif
+
+namespace zldsp {
+    namespace {
+        thread_local bool insideSection ZL_AUDIT_TLS = false;
+        // set while a violation is recorded, so that the recording itself is not audited
+        thread_local bool reporting ZL_AUDIT_TLS = false;
+        std::atomic<int> numViolations{0};
+        std::mutex violationLock;
+
+        std::vector<RealtimeAudit::Violation> &getStore() {
+            static std::vector<RealtimeAudit::Violation> store;
+            return store;
+        }
+
+        const char *getKindName(RealtimeAudit::Kind kind) {
+            switch (kind) {
+                case RealtimeAudit::heap:
+                    return "heap";
+                case RealtimeAudit::lock:
+                    return "lock";
+                case RealtimeAudit::systemCall:
+                    return "system call";
+            }
+            return "";
+        }
+    }
+
+    RealtimeAudit::ScopedSection::ScopedSection() : wasInside(insideSection) {
+        insideSection = true;
+    }
+
+    RealtimeAudit::ScopedSection::~ScopedSection() {
+        insideSection = wasInside;
+    }
+
+    void RealtimeAudit::report(Kind kind, const char *what) noexcept {
+        if (!insideSection || reporting) {
+            return;
+        }
+        reporting = true;
+        numViolations.fetch_add(1, std::memory_order_relaxed);
+        try {
+            Violation violation{kind, what, juce::SystemStats::getStackBacktrace()};
+            const std::lock_guard<std::mutex> guard(violationLock);
+            getStore().push_back(std::move(violation));
+        } catch (...) {}
+        reporting = false;
+    }
+
+    int RealtimeAudit::getNumViolations() noexcept {
+        return numViolations.load(std::memory_order_relaxed);
+    }
+
+    std::vector<RealtimeAudit::Violation> RealtimeAudit::getViolations() {
+        const std::lock_guard<std::mutex> guard(violationLock);
+        return getStore();
+    }
+
+    juce::String RealtimeAudit::getReport() {
+        juce::String result;
+        for (const auto &violation: getViolations()) {
+            result << getKindName(violation.kind) << ": " << violation.what << juce::newLine
+                   << violation.backtrace << juce::newLine;
+        }
+        return result;
+    }
+
+    void RealtimeAudit::clear() {
+        const std::lock_guard<std::mutex> guard(violationLock);
+        getStore().clear();
+        numViolations.store(0, std::memory_order_relaxed);
+    }
+}
+
+using zldsp::RealtimeAudit;
+
+#if ZL_AUDIT_GLIBC_HOOKS
+
+// glibc exports its allocator under these names, which lets the hooks forward without dlsym
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void *__libc_memalign(size_t, size_t);
+void __libc_free(void *);
+
+void *malloc(size_t size) {
+    RealtimeAudit::report(RealtimeAudit::heap, "malloc");
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t num, size_t size) {
+    RealtimeAudit::report(RealtimeAudit::heap, "calloc");
+    return __libc_calloc(num, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    RealtimeAudit::report(RealtimeAudit::heap, "realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    RealtimeAudit::report(RealtimeAudit::heap, "aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    RealtimeAudit::report(RealtimeAudit::heap, "posix_memalign");
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr == nullptr ? ENOMEM : 0;
+}
+
+void free(void *ptr) {
+    if (ptr != nullptr) {
+        RealtimeAudit::report(RealtimeAudit::heap, "free");
+    }
+    __libc_free(ptr);
+}
+}
+
+namespace {
+    template<typename Function>
+    Function getNext(const char *name) {
+        return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+    }
+}
+
+// every hook reports, then forwards to the next definition of the same symbol
+#define ZL_AUDIT_HOOK(kind, result, name, parameters, arguments)                \
+    extern "C" result name parameters {                                          \
+        static const auto next = getNext<result (*) parameters>(#name);          \
+        RealtimeAudit::report(RealtimeAudit::kind, #name);                       \
+        return next arguments;                                                   \
+    }
+
+ZL_AUDIT_HOOK(lock, int, pthread_mutex_lock, (pthread_mutex_t * mutex), (mutex))
+ZL_AUDIT_HOOK(lock, int, pthread_rwlock_rdlock, (pthread_rwlock_t * rwlock), (rwlock))
+ZL_AUDIT_HOOK(lock, int, pthread_rwlock_wrlock, (pthread_rwlock_t * rwlock), (rwlock))
+ZL_AUDIT_HOOK(lock, int, pthread_cond_wait, (pthread_cond_t * cond, pthread_mutex_t * mutex), (cond, mutex))
+ZL_AUDIT_HOOK(lock, int, sem_wait, (sem_t * sem), (sem))
+ZL_AUDIT_HOOK(systemCall, ssize_t, read, (int fd, void *buf, size_t count), (fd, buf, count))
+ZL_AUDIT_HOOK(systemCall, ssize_t, write, (int fd, const void *buf, size_t count), (fd, buf, count))
+ZL_AUDIT_HOOK(systemCall, FILE *, fopen, (const char *path, const char *mode), (path, mode))
+ZL_AUDIT_HOOK(systemCall, int, nanosleep, (const struct timespec *req, struct timespec *rem), (req, rem))
+ZL_AUDIT_HOOK(systemCall, int, usleep, (useconds_t usec), (usec))
+ZL_AUDIT_HOOK(systemCall, int, sched_yield, (), ())
+
+#undef ZL_AUDIT_HOOK
+
+#else
+
+void *operator new(std::size_t size) {
+    RealtimeAudit::report(RealtimeAudit::heap, "operator new");
+    if (auto *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        RealtimeAudit::report(RealtimeAudit::heap, "operator delete");
+    }
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,73 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+#ifndef ZLINFLATOR_REALTIMEAUDIT_H
+#define ZLINFLATOR_REALTIMEAUDIT_H
+
+#include <juce_core/juce_core.h>
+
+#if ZL_REALTIME_AUDIT
+
+namespace zldsp {
+    /**
+     * realtime safety audit, enabled with the ZL_REALTIME_AUDIT build option
+     * while a ScopedSection is alive on a thread, the heap calls, mutex acquisitions and
+     * blocking system calls of that thread are recorded together with a backtrace
+     * on glibc every hook is available, elsewhere only operator new / delete are audited
+     */
+    class RealtimeAudit {
+    public:
+        enum Kind {
+            heap,
+            lock,
+            systemCall
+        };
+
+        struct Violation {
+            Kind kind;
+            juce::String what, backtrace;
+        };
+
+        class ScopedSection {
+        public:
+            ScopedSection();
+
+            ~ScopedSection();
+
+        private:
+            bool wasInside;
+            JUCE_DECLARE_NON_COPYABLE(ScopedSection)
+        };
+
+        /** called by the hooks, does nothing outside of a section */
+        static void report(Kind kind, const char *what) noexcept;
+
+        static int getNumViolations() noexcept;
+
+        static std::vector<Violation> getViolations();
+
+        /** every violation as readable text, one backtrace each */
+        static juce::String getReport();
+
+        static void clear();
+    };
+}
+
+#define ZL_REALTIME_AUDIT_SECTION const zldsp::RealtimeAudit::ScopedSection zlRealtimeAuditSection
+
+#else
+
+#define ZL_REALTIME_AUDIT_SECTION
+
+#endif
+
+#endif //ZLINFLATOR_REALTIMEAUDIT_H
@@ -29,39 +29,29 @@ namespace shaper {
     };
 
     template<typename FloatType>
-    class Shaper {
+    class IdentityShaper {
     public:
-        Shaper() = default;
+        void setParameters(FloatType, bool) {}
 
-        virtual ~Shaper() = default;
+        static constexpr size_t degree = 1;
 
-        FloatType operator()(FloatType x) const {
-            return shape(x);
-        }
-
-        virtual void setParameters(FloatType curve, bool compensation) = 0;
-
-    private:
-        virtual FloatType basic(FloatType x) const = 0;
+        std::array<FloatType, 4> getCoefficients() const { return {1, 0, 0, 0}; }
 
-        virtual FloatType shape(FloatType x) const = 0;
-    };
-
-    template<typename FloatType>
-    class IdentityShaper : public Shaper<FloatType> {
-    public:
-        void setParameters(FloatType, bool) override {}
+        template<typename SampleType>
+        SampleType operator()(SampleType x) const { return shape(x); }
 
     private:
-        FloatType basic(FloatType x) const override { return x; }
+        template<typename SampleType>
+        SampleType basic(SampleType x) const { return x; }
 
-        FloatType shape(FloatType x) const override { return basic(x); }
+        template<typename SampleType>
+        SampleType shape(SampleType x) const { return basic(x); }
     };
 
     template<typename FloatType>
-    class QuadraticShaper : public Shaper<FloatType> {
+    class QuadraticShaper {
     public:
-        void setParameters(FloatType, bool compensation) override {
+        void setParameters(FloatType, bool compensation) {
             if (compensation) {
                 scale = 1 / FloatType(1.7619606880293588);
             } else {
@@ -69,18 +59,27 @@ namespace shaper {
             }
         }
 
+        static constexpr size_t degree = 2;
+
+        std::array<FloatType, 4> getCoefficients() const { return {2 * scale, -scale, 0, 0}; }
+
+        template<typename SampleType>
+        SampleType operator()(SampleType x) const { return shape(x); }
+
     private:
         FloatType scale = 1;
 
-        FloatType basic(FloatType x) const override { return scale * x * (2 - x); }
+        template<typename SampleType>
+        SampleType basic(SampleType x) const { return x * (x * FloatType(-1) + FloatType(2)) * scale; }
 
-        FloatType shape(FloatType x) const override { return basic(x); }
+        template<typename SampleType>
+        SampleType shape(SampleType x) const { return basic(x); }
     };
 
     template<typename FloatType>
-    class CubicShaper : public Shaper<FloatType> {
+    class CubicShaper {
     public:
-        void setParameters(FloatType, bool compensation) override {
+        void setParameters(FloatType, bool compensation) {
             if (compensation) {
                 scale = 1 / FloatType(1.0982883051371357);
             } else {
@@ -88,18 +87,27 @@ namespace shaper {
             }
         }
 
+        static constexpr size_t degree = 3;
+
+        std::array<FloatType, 4> getCoefficients() const { return {scale, scale, -scale, 0}; }
+
+        template<typename SampleType>
+        SampleType operator()(SampleType x) const { return shape(x); }
+
     private:
         FloatType scale = 1;
 
-        FloatType basic(FloatType x) const override { return scale * x * (1 + x * (1 - x)); }
+        template<typename SampleType>
+        SampleType basic(SampleType x) const { return x * (x * (x * FloatType(-1) + FloatType(1)) + FloatType(1)) * scale; }
 
-        FloatType shape(FloatType x) const override { return basic(x); }
+        template<typename SampleType>
+        SampleType shape(SampleType x) const { return basic(x); }
     };
 
     template<typename FloatType>
-    class QuarticShaper : public Shaper<FloatType> {
+    class QuarticShaper {
     public:
-        void setParameters(FloatType curve, bool compensation) override {
+        void setParameters(FloatType curve, bool compensation) {
             curve = -6 + 6 * curve;
             a = (4 + curve) / 2;
             b = -5 - curve;
@@ -111,43 +119,84 @@ namespace shaper {
             }
         }
 
+        static constexpr size_t degree = 4;
+
+        std::array<FloatType, 4> getCoefficients() const { return {scale, scale * c, scale * b, scale * a}; }
+
+        template<typename SampleType>
+        SampleType operator()(SampleType x) const { return shape(x); }
+
     private:
         FloatType a, b, c, scale = 1;
 
-        FloatType basic(FloatType x) const override { return scale * x * (1 + x * (c + x * (b + a * x))); }
+        template<typename SampleType>
+        SampleType basic(SampleType x) const { return x * (x * (x * (x * a + b) + c) + FloatType(1)) * scale; }
 
-        FloatType shape(FloatType x) const override { return basic(x); }
+        template<typename SampleType>
+        SampleType shape(SampleType x) const { return basic(x); }
     };
 
 //    template<typename FloatType>
-//    class SigmodShaper : public Shaper<FloatType> {
+//    class SigmodShaper {
 //    public:
-//        void setParameters(FloatType curve) override {
+//        void setParameters(FloatType curve) {
 //            trueCurve = curve * FloatType(2.5) + FloatType(0.5);
 //            b = -basic(0);
 //            k = FloatType(1) / (basic(1) + b);
 //        }
 //
+//        FloatType operator()(FloatType x) const { return shape(x); }
+//
 //    private:
 //        FloatType trueCurve, k, b;
 //
-//        FloatType basic(FloatType x) const override {
+//        FloatType basic(FloatType x) const {
 //            return FloatType(1) / (1 + std::exp(-trueCurve * x));
 //        }
 //
-//        FloatType shape(FloatType x) const override {
+//        FloatType shape(FloatType x) const {
 //            return k * (basic(x) + b);
 //        }
 //    };
 
+    /**
+     * sin(x) for x in [0, pi / 2], by an odd polynomial
+     * float uses a 9th order minimax polynomial, its relative error is below 5.4e-9 (before rounding),
+     * which is below the resolution of float
+     * double uses the Taylor polynomial up to x^19, its relative error is below 1e-15
+     * the polynomials only use + and *, hence they also work on juce::dsp::SIMDRegister
+     */
+    template<typename FloatType, typename SampleType>
+    inline SampleType fastSin(SampleType x) {
+        const auto x2 = x * x;
+        if constexpr (std::is_same_v<FloatType, double>) {
+            auto y = x2 * static_cast<FloatType>(-8.22063524662433e-18) + static_cast<FloatType>(2.8114572543455206e-15);
+            y = y * x2 + static_cast<FloatType>(-7.647163731819816e-13);
+            y = y * x2 + static_cast<FloatType>(1.6059043836821613e-10);
+            y = y * x2 + static_cast<FloatType>(-2.505210838544172e-08);
+            y = y * x2 + static_cast<FloatType>(2.7557319223985893e-06);
+            y = y * x2 + static_cast<FloatType>(-0.0001984126984126984);
+            y = y * x2 + static_cast<FloatType>(0.008333333333333333);
+            y = y * x2 + static_cast<FloatType>(-0.16666666666666666);
+            y = y * x2 + static_cast<FloatType>(1.0);
+            return x * y;
+        } else {
+            return x * (x2 * (x2 * (x2 * (x2 * static_cast<FloatType>(2.6019030676854223e-06)
+                                          + static_cast<FloatType>(-0.00019807418727439723))
+                                    + static_cast<FloatType>(0.0083330251389695))
+                              + static_cast<FloatType>(-0.16666656684007158))
+                        + static_cast<FloatType>(0.99999999468600731));
+        }
+    }
+
     template<typename FloatType>
-    class SinShaper : public Shaper<FloatType> {
+    class SinShaper {
     public:
-        void setParameters(FloatType curve, bool compensation) override {
+        void setParameters(FloatType curve, bool compensation) {
             trueCurve = (std::pow(curve, FloatType(0.427)) * static_cast<FloatType>(0.999) +
                          static_cast<FloatType>(0.001)) * juce::MathConstants<FloatType>::pi / 2;
-            b = -basic(0);
-            k = FloatType(1) / (basic(1) + b);
+            b = -basic(FloatType(0));
+            k = FloatType(1) / (basic(FloatType(1)) + b);
             if (compensation) {
                 scale = 1 / (FloatType(0.48339138157922157) * curve + FloatType(0.9999698009251106));
             } else {
@@ -155,78 +204,256 @@ namespace shaper {
             }
         }
 
+        template<typename SampleType>
+        SampleType operator()(SampleType x) const { return shape(x); }
+
     private:
         FloatType trueCurve, k, b, scale = 1;
 
-        FloatType basic(FloatType x) const override {
-            return std::sin(x * trueCurve);
+        // x * trueCurve stays within [0, pi / 2]
+        template<typename SampleType>
+        SampleType basic(SampleType x) const {
+            return fastSin<FloatType>(x * trueCurve);
         }
 
-        FloatType shape(FloatType x) const override {
-            return scale * k * (basic(x) + b);
+        template<typename SampleType>
+        SampleType shape(SampleType x) const {
+            return (basic(x) + b) * (scale * k);
         }
     };
 
-    template<typename FloatType>
-    static std::unique_ptr<Shaper<FloatType>> makeShaper(ShaperType type) {
-        if (type == ShaperType::identity) {
-            return std::make_unique<IdentityShaper<FloatType>>();
-        } else if (type == ShaperType::quadratic) {
-            return std::make_unique<QuadraticShaper<FloatType>>();
-        } else if (type == ShaperType::cubic) {
-            return std::make_unique<CubicShaper<FloatType>>();
-        } else if (type == ShaperType::quartic) {
-            return std::make_unique<QuarticShaper<FloatType>>();
-//        } else if (type == ShaperType::sigmod) {
-//            return std::make_unique<SigmodShaper<FloatType>>();
-        } else {
-            return std::make_unique<SinShaper<FloatType>>();
-        }
-    }
-
+    /**
+     * whether the shaper is a polynomial, i.e. it provides degree and getCoefficients()
+     */
+    template<size_t Type>
+    inline constexpr bool isPolynomial = Type == ShaperType::identity || Type == ShaperType::quadratic ||
+                                         Type == ShaperType::cubic || Type == ShaperType::quartic;
+
+    /**
+     * mix two shapers with weights
+     * each (type1, type2) pair is compiled into its own kernel, which is picked in setTypes,
+     * so the per-sample loop contains no virtual calls and can be inlined
+     * @tparam FloatType
+     */
     template<typename FloatType>
     class ShaperMixer {
     public:
+        using ScalarKernel = FloatType (*)(const ShaperMixer &, FloatType);
+        using BlockKernel = void (*)(const ShaperMixer &, const ShaperMixer &, const FloatType *, FloatType *,
+                                     size_t, FloatType, FloatType, FloatType, FloatType);
+
         ShaperMixer() {
-            for (size_t i = 0; i < ShaperType::ShaperNUM; ++i) {
-                shaper1[i] = makeShaper<FloatType>(static_cast<ShaperType>(i));
-                shaper2[i] = makeShaper<FloatType>(static_cast<ShaperType>(i));
-            }
             setShapes(zldsp::curve1::formatV(zldsp::curve1::defaultV),
                       zldsp::curve2::formatV(zldsp::curve2::defaultV),
                       zldsp::weight::formatV(zldsp::weight::defaultV),
                       false);
+            setTypes(static_cast<size_t>(zldsp::style1::defaultI),
+                     static_cast<size_t>(zldsp::style2::defaultI));
         }
 
         ~ShaperMixer() = default;
 
         FloatType operator()(FloatType x) const {
-            return shape(x);
+            return scalarKernel(*this, x);
+        }
+
+        /**
+         * shape a block of samples: out = sgn(x) * mix(min(|x|, 1)) * wet + x * (1 - wet)
+         * wet moves linearly from wetStart to wetEnd across the block
+         * in and out may point to the same buffer
+         */
+        void process(const FloatType *in, FloatType *out, size_t numSamples,
+                     FloatType wetStart, FloatType wetEnd) const {
+            blockKernel(*this, *this, in, out, numSamples, wetStart, wetEnd,
+                        static_cast<FloatType>(0), static_cast<FloatType>(1));
+        }
+
+        /**
+         * same as process, but the curve also moves linearly from the curve of from to this one
+         * rampStart / rampEnd select the part of the move covered by this block, so that a block
+         * can be processed in chunks; from must have the same types as this mixer
+         */
+        void processRamp(const ShaperMixer &from, const FloatType *in, FloatType *out, size_t numSamples,
+                         FloatType wetStart, FloatType wetEnd,
+                         FloatType rampStart = 0, FloatType rampEnd = 1) const {
+            jassert(from.m_type1 == m_type1 && from.m_type2 == m_type2);
+            rampKernel(from, *this, in, out, numSamples, wetStart, wetEnd, rampStart, rampEnd);
         }
 
         void setShapes(FloatType curve1, FloatType curve2, FloatType weight, bool compensation) {
             m_weight2 = weight;
             m_weight1 = static_cast<FloatType>(1) - weight;
-            for (size_t i = 0; i < ShaperType::ShaperNUM; ++i) {
-                shaper1[i]->setParameters(curve1, compensation);
-                shaper2[i]->setParameters(curve2, compensation);
-            }
+            std::apply([&](auto &... s) { (s.setParameters(curve1, compensation), ...); }, shaper1);
+            std::apply([&](auto &... s) { (s.setParameters(curve2, compensation), ...); }, shaper2);
+            updateCoefficients();
         }
 
         void setTypes(size_t type1, size_t type2) {
-            m_type1 = type1;
-            m_type2 = type2;
+            m_type1 = juce::jmin(type1, static_cast<size_t>(ShaperType::ShaperNUM - 1));
+            m_type2 = juce::jmin(type2, static_cast<size_t>(ShaperType::ShaperNUM - 1));
+            updateCoefficients();
+            scalarKernel = scalarKernels[m_type1][m_type2];
+            blockKernel = blockKernels[m_type1][m_type2];
+            rampKernel = rampKernels[m_type1][m_type2];
         }
 
     private:
-        std::array<std::unique_ptr<Shaper<FloatType>>, ShaperType::ShaperNUM> shaper1, shaper2;
+        // the order must follow ShaperType
+        using Shapers = std::tuple<IdentityShaper<FloatType>, QuadraticShaper<FloatType>, CubicShaper<FloatType>,
+                QuarticShaper<FloatType>, SinShaper<FloatType>>;
+        static_assert(std::tuple_size_v<Shapers> == ShaperType::ShaperNUM);
+
+        Shapers shaper1, shaper2;
         FloatType m_weight1, m_weight2;
         size_t m_type1 = static_cast<size_t>(zldsp::style1::defaultI);
         size_t m_type2 = static_cast<size_t>(zldsp::style2::defaultI);
+        ScalarKernel scalarKernel;
+        BlockKernel blockKernel, rampKernel;
+        // x^1 ... x^4 coefficients of the weighted sum, valid when both shapers are polynomials
+        std::array<FloatType, 4> m_coefficients{};
+
+        template<size_t Type>
+        std::array<FloatType, 4> getCoefficients(const Shapers &shapers) const {
+            if constexpr (isPolynomial<Type>) {
+                return std::get<Type>(shapers).getCoefficients();
+            } else {
+                return {};
+            }
+        }
+
+        template<size_t... Type>
+        std::array<FloatType, 4> getCoefficients(const Shapers &shapers, size_t type,
+                                                 std::index_sequence<Type...>) const {
+            std::array<FloatType, 4> coefficients{};
+            ((coefficients = Type == type ? getCoefficients<Type>(shapers) : coefficients), ...);
+            return coefficients;
+        }
+
+        void updateCoefficients() {
+            const auto c1 = getCoefficients(shaper1, m_type1, std::make_index_sequence<ShaperType::ShaperNUM>{});
+            const auto c2 = getCoefficients(shaper2, m_type2, std::make_index_sequence<ShaperType::ShaperNUM>{});
+            for (size_t i = 0; i < m_coefficients.size(); ++i) {
+                m_coefficients[i] = c1[i] * m_weight1 + c2[i] * m_weight2;
+            }
+        }
 
-        FloatType shape(FloatType x) const {
-            return (*shaper1[m_type1])(x) * m_weight1 + (*shaper2[m_type2])(x) * m_weight2;
+        template<size_t Degree, typename SampleType>
+        static SampleType horner(const std::array<FloatType, 4> &p, SampleType x) {
+            auto y = x * p[Degree - 1];
+            for (size_t i = Degree - 1; i > 0; --i) {
+                y = (y + p[i - 1]) * x;
+            }
+            return y;
         }
+
+        template<size_t Type1, size_t Type2, typename SampleType>
+        static SampleType shape(const ShaperMixer &m, SampleType x) {
+            if constexpr (isPolynomial<Type1> && isPolynomial<Type2>) {
+                // both curves are merged into a single polynomial in updateCoefficients
+                constexpr auto degree = std::max(std::tuple_element_t<Type1, Shapers>::degree,
+                                                 std::tuple_element_t<Type2, Shapers>::degree);
+                return horner<degree>(m.m_coefficients, x);
+            } else {
+                return std::get<Type1>(m.shaper1)(x) * m.m_weight1 + std::get<Type2>(m.shaper2)(x) * m.m_weight2;
+            }
+        }
+
+        /** the curve at ramp position t, moving from the mixer from to the mixer to */
+        template<size_t Type1, size_t Type2, bool Ramp, typename SampleType>
+        static SampleType shapeRamp(const ShaperMixer &from, const ShaperMixer &to, SampleType x, SampleType t) {
+            const auto y = shape<Type1, Type2>(to, x);
+            if constexpr (Ramp) {
+                // for polynomial pairs this equals interpolating the fused coefficients
+                const auto y0 = shape<Type1, Type2>(from, x);
+                return y0 + (y - y0) * t;
+            } else {
+                juce::ignoreUnused(from, t);
+                return y;
+            }
+        }
+
+        template<size_t Type1, size_t Type2, bool Ramp>
+        static void processScalar(const ShaperMixer &from, const ShaperMixer &to, const FloatType *in, FloatType *out,
+                                  size_t begin, size_t end, size_t numSamples, FloatType wetStart, FloatType wetEnd,
+                                  FloatType rampStart, FloatType rampEnd) {
+            const auto step = static_cast<FloatType>(1) / static_cast<FloatType>(numSamples);
+            for (size_t i = begin; i < end; ++i) {
+                const auto u = static_cast<FloatType>(i) * step;
+                const auto t = rampStart + (rampEnd - rampStart) * u;
+                const auto wet = wetStart + (wetEnd - wetStart) * u;
+                const auto x = in[i];
+                const auto y = shapeRamp<Type1, Type2, Ramp>(from, to, juce::jmin(static_cast<FloatType>(1), std::abs(x)), t);
+                out[i] = x + ((x > 0 ? y : -y) - x) * wet;
+            }
+        }
+
+        template<size_t Type1, size_t Type2, bool Ramp>
+        static void processBlock(const ShaperMixer &from, const ShaperMixer &to, const FloatType *in, FloatType *out,
+                                 size_t numSamples, FloatType wetStart, FloatType wetEnd,
+                                 FloatType rampStart, FloatType rampEnd) {
+            using SIMDType = juce::dsp::SIMDRegister<FloatType>;
+            constexpr auto width = SIMDType::SIMDNumElements;
+            // scalar head until out is aligned, the SIMD body needs in to share the same alignment
+            size_t head = 0;
+            while (head < numSamples && !SIMDType::isSIMDAligned(out + head)) {
+                ++head;
+            }
+            if (head == numSamples || !SIMDType::isSIMDAligned(in + head)) {
+                processScalar<Type1, Type2, Ramp>(from, to, in, out, 0, numSamples, numSamples, wetStart, wetEnd,
+                                                  rampStart, rampEnd);
+                return;
+            }
+            processScalar<Type1, Type2, Ramp>(from, to, in, out, 0, head, numSamples, wetStart, wetEnd,
+                                              rampStart, rampEnd);
+            const auto one = SIMDType::expand(static_cast<FloatType>(1));
+            const auto two = SIMDType::expand(static_cast<FloatType>(2));
+            const auto zero = SIMDType::expand(static_cast<FloatType>(0));
+            const auto step = static_cast<FloatType>(1) / static_cast<FloatType>(numSamples);
+            auto lanes = zero;
+            for (size_t k = 0; k < width; ++k) {
+                lanes.set(k, static_cast<FloatType>(k));
+            }
+            auto i = head;
+            for (; i + width <= numSamples; i += width) {
+                const auto u = (lanes + static_cast<FloatType>(i)) * step;
+                const auto t = u * (rampEnd - rampStart) + rampStart;
+                const auto wet = u * (wetEnd - wetStart) + wetStart;
+                const auto x = SIMDType::fromRawArray(in + i);
+                const auto y = shapeRamp<Type1, Type2, Ramp>(from, to, SIMDType::min(SIMDType::abs(x), one), t);
+                // sgn(x) without a branch: -1 + 2 * (x > 0)
+                const auto sgn = (two & SIMDType::greaterThan(x, zero)) - one;
+                (x + (y * sgn - x) * wet).copyToRawArray(out + i);
+            }
+            processScalar<Type1, Type2, Ramp>(from, to, in, out, i, numSamples, numSamples, wetStart, wetEnd,
+                                              rampStart, rampEnd);
+        }
+
+        template<size_t Type1, size_t... Type2>
+        static constexpr std::array<ScalarKernel, ShaperType::ShaperNUM>
+        makeScalarRow(std::index_sequence<Type2...>) { return {&shape<Type1, Type2, FloatType>...}; }
+
+        template<size_t... Type1>
+        static constexpr std::array<std::array<ScalarKernel, ShaperType::ShaperNUM>, ShaperType::ShaperNUM>
+        makeScalarKernels(std::index_sequence<Type1...>) {
+            return {makeScalarRow<Type1>(std::make_index_sequence<ShaperType::ShaperNUM>{})...};
+        }
+
+        template<bool Ramp, size_t Type1, size_t... Type2>
+        static constexpr std::array<BlockKernel, ShaperType::ShaperNUM>
+        makeBlockRow(std::index_sequence<Type2...>) { return {&processBlock<Type1, Type2, Ramp>...}; }
+
+        template<bool Ramp, size_t... Type1>
+        static constexpr std::array<std::array<BlockKernel, ShaperType::ShaperNUM>, ShaperType::ShaperNUM>
+        makeBlockKernels(std::index_sequence<Type1...>) {
+            return {makeBlockRow<Ramp, Type1>(std::make_index_sequence<ShaperType::ShaperNUM>{})...};
+        }
+
+        inline static constexpr auto scalarKernels =
+                makeScalarKernels(std::make_index_sequence<ShaperType::ShaperNUM>{});
+        inline static constexpr auto blockKernels =
+                makeBlockKernels<false>(std::make_index_sequence<ShaperType::ShaperNUM>{});
+        inline static constexpr auto rampKernels =
+                makeBlockKernels<true>(std::make_index_sequence<ShaperType::ShaperNUM>{});
     };
 } // namespace shaper
 
@@ -0,0 +1,69 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+#ifndef ZLINFLATOR_SHAPERTABLE_H
+#define ZLINFLATOR_SHAPERTABLE_H
+
+#include "ShaperFunctions.h"
+#include "TripleBuffer.h"
+
+namespace shaper {
+    /**
+     * the ShaperMixer curve on [0, 1], sampled into a linearly interpolated lookup table
+     * build() is called whenever the curve changes (off the audio thread),
+     * process() only reads the latest published table, so its cost does not depend on the styles
+     * with 4096 intervals the interpolation error is below 1e-6 for every built-in style
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class ShaperTable {
+    public:
+        static constexpr size_t tableSize = 4096;
+
+        ShaperTable() = default;
+
+        void build(const ShaperMixer<FloatType> &mixer) {
+            auto &table = tables.getWriteBuffer();
+            for (size_t i = 0; i <= tableSize; ++i) {
+                table[i] = mixer(static_cast<FloatType>(i) / static_cast<FloatType>(tableSize));
+            }
+            // guard point, so that x = 1 can be interpolated without a branch
+            table[tableSize + 1] = table[tableSize];
+            tables.publish();
+        }
+
+        /**
+         * shape a block of samples: out = sgn(x) * table(min(|x|, 1)) * wet + x * (1 - wet)
+         * wet moves linearly from wetStart to wetEnd across the block
+         * in and out may point to the same buffer
+         */
+        void process(const FloatType *in, FloatType *out, size_t numSamples, FloatType wetStart, FloatType wetEnd) {
+            tables.update();
+            const auto &table = tables.getReadBuffer();
+            const auto wetStep = (wetEnd - wetStart) / static_cast<FloatType>(numSamples);
+            for (size_t i = 0; i < numSamples; ++i) {
+                const auto x = in[i];
+                const auto pos = juce::jmin(static_cast<FloatType>(1), std::abs(x)) * static_cast<FloatType>(tableSize);
+                const auto idx = static_cast<size_t>(pos);
+                const auto frac = pos - static_cast<FloatType>(idx);
+                const auto y = table[idx] + frac * (table[idx + 1] - table[idx]);
+                const auto wet = wetStart + wetStep * static_cast<FloatType>(i);
+                out[i] = x + ((x > 0 ? y : -y) - x) * wet;
+            }
+        }
+
+    private:
+        zldsp::TripleBuffer<std::array<FloatType, tableSize + 2>> tables;
+    };
+}
+
+#endif //ZLINFLATOR_SHAPERTABLE_H
@@ -0,0 +1,140 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#ifndef ZLINFLATOR_STAGELOAD_H
+#define ZLINFLATOR_STAGELOAD_H
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+
+namespace zldsp {
+    /**
+     * the time spent in each stage of the processing, as a fraction of the block duration
+     * the audio thread times the stages of a block with a Clock, update() folds the ticks into smoothed loads,
+     * which any thread can read without a lock
+     * a stage that runs on several threads (channel pairs on the worker pool) adds up the time of every thread
+     */
+    class StageLoad {
+    public:
+        enum Stage {
+            inGain,
+            meterIn,
+            upSampling,
+            crossover,
+            shaper,
+            downSampling,
+            outGain,
+            meterOut,
+            stageNUM
+        };
+
+        inline static const std::array<const char *, stageNUM> names{
+                "In Gain", "In Meter", "Upsampling", "Crossover", "Shaper", "Downsampling", "Out Gain", "Out Meter"};
+
+        using Ticks = std::array<juce::int64, stageNUM>;
+
+        /**
+         * adds the ticks since the previous lap to a stage, an inactive clock never reads the time
+         */
+        class Clock {
+        public:
+            Clock(Ticks &target, bool isActive) : ticks(target), active(isActive) {
+                restart();
+            }
+
+            void lap(Stage stage) {
+                if (active) {
+                    const auto now = juce::Time::getHighResolutionTicks();
+                    ticks[stage] += now - last;
+                    last = now;
+                }
+            }
+
+            /** the next lap starts here, the time since the previous lap is not counted */
+            void restart() {
+                if (active) {
+                    last = juce::Time::getHighResolutionTicks();
+                }
+            }
+
+        private:
+            Ticks &ticks;
+            const bool active;
+            juce::int64 last = 0;
+        };
+
+        /** the stages are only timed while enabled, the loads keep their last values otherwise */
+        void setEnabled(bool shouldBeEnabled) {
+            enabled.store(shouldBeEnabled, std::memory_order_relaxed);
+        }
+
+        bool isEnabled() const {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        void prepare(double rate) {
+            sampleRate.store(rate, std::memory_order_relaxed);
+            reset();
+        }
+
+        void reset() {
+            for (auto &load: loads) {
+                load.store(0.f, std::memory_order_relaxed);
+            }
+        }
+
+        /** audio thread: fold the ticks of a block of numSamples into the loads */
+        void update(const Ticks &ticks, size_t numSamples) {
+            if (numSamples == 0) {
+                return;
+            }
+            const auto scale = sampleRate.load(std::memory_order_relaxed) / static_cast<double>(numSamples);
+            for (size_t i = 0; i < stageNUM; ++i) {
+                const auto load = static_cast<float>(juce::Time::highResolutionTicksToSeconds(ticks[i]) * scale);
+                const auto previous = loads[i].load(std::memory_order_relaxed);
+                loads[i].store(previous + (load - previous) * smoothing, std::memory_order_relaxed);
+            }
+        }
+
+        /** the fraction of the block duration spent in a stage, smoothed over recent blocks */
+        float getLoad(Stage stage) const {
+            return loads[stage].load(std::memory_order_relaxed);
+        }
+
+        std::array<float, stageNUM> getLoads() const {
+            std::array<float, stageNUM> result{};
+            for (size_t i = 0; i < stageNUM; ++i) {
+                result[i] = loads[i].load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+        float getTotalLoad() const {
+            float total = 0.f;
+            for (const auto &load: loads) {
+                total += load.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+    private:
+        // weight of the latest block, the same as the oversampler load of WaveShaper
+        static constexpr float smoothing = 0.1f;
+        std::atomic<bool> enabled{false};
+        std::atomic<double> sampleRate{44100};
+        std::array<std::atomic<float>, stageNUM> loads{};
+    };
+}
+
+#endif //ZLINFLATOR_STAGELOAD_H
@@ -0,0 +1,137 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+#ifndef ZLINFLATOR_THREEBANDCROSSOVER_H
+#define ZLINFLATOR_THREEBANDCROSSOVER_H
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace zldsp {
+    /**
+     * a 3-band Linkwitz-Riley (LR4) crossover that computes all bands in a single pass
+     * it is the same network as LR lowpass / highpass at lowFreq followed by
+     * an allpass at highFreq on the low band and LR lowpass / highpass at highFreq on the rest,
+     * with the TPT structure of juce::dsp::LinkwitzRileyFilter
+     * the filter state of a channel lives in registers while a block is processed
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class ThreeBandCrossover {
+    public:
+        ThreeBandCrossover() { update(); }
+
+        void prepare(const juce::dsp::ProcessSpec &spec) {
+            states.resize(spec.numChannels);
+            setSampleRate(spec.sampleRate);
+        }
+
+        /** also resets the state, called when the oversampling rate changes */
+        void setSampleRate(double rate) {
+            sampleRate = rate;
+            update();
+            reset();
+        }
+
+        void setCutoffFrequencies(FloatType lowFreq, FloatType highFreq) {
+            if (lowFreq != lowCutoff || highFreq != highCutoff) {
+                lowCutoff = lowFreq;
+                highCutoff = highFreq;
+                update();
+            }
+        }
+
+        void reset() {
+            std::fill(states.begin(), states.end(), State{});
+        }
+
+        size_t getMemoryUsage() const {
+            return states.capacity() * sizeof(State);
+        }
+
+        /**
+         * split one channel into the three bands, the band buffers must not alias in
+         */
+        void process(size_t channel, const FloatType *in, FloatType *low, FloatType *mid, FloatType *high,
+                     size_t numSamples) {
+            auto s = states[channel];
+            for (size_t i = 0; i < numSamples; ++i) {
+                // LR4 at lowFreq, lowpass and highpass from the same pair of 2nd order sections
+                const auto xH = (in[i] - lowCoefficients.r2g * s.low1 - s.low2) * lowCoefficients.h;
+                const auto xB = lowCoefficients.g * xH + s.low1;
+                s.low1 = lowCoefficients.g * xH + xB;
+                const auto xL = lowCoefficients.g * xB + s.low2;
+                s.low2 = lowCoefficients.g * xB + xL;
+                const auto xH2 = (xL - lowCoefficients.r2g * s.low3 - s.low4) * lowCoefficients.h;
+                const auto xB2 = lowCoefficients.g * xH2 + s.low3;
+                s.low3 = lowCoefficients.g * xH2 + xB2;
+                const auto xL2 = lowCoefficients.g * xB2 + s.low4;
+                s.low4 = lowCoefficients.g * xB2 + xL2;
+                const auto lowBand = xL2;
+                const auto restBand = xL - R2 * xB + xH - xL2;
+
+                // allpass at highFreq, keeps the low band in phase with the other two
+                const auto aH = (lowBand - highCoefficients.r2g * s.all1 - s.all2) * highCoefficients.h;
+                const auto aB = highCoefficients.g * aH + s.all1;
+                s.all1 = highCoefficients.g * aH + aB;
+                const auto aL = highCoefficients.g * aB + s.all2;
+                s.all2 = highCoefficients.g * aB + aL;
+                low[i] = aL - R2 * aB + aH;
+
+                // LR4 at highFreq on the rest
+                const auto yH = (restBand - highCoefficients.r2g * s.high1 - s.high2) * highCoefficients.h;
+                const auto yB = highCoefficients.g * yH + s.high1;
+                s.high1 = highCoefficients.g * yH + yB;
+                const auto yL = highCoefficients.g * yB + s.high2;
+                s.high2 = highCoefficients.g * yB + yL;
+                const auto yH2 = (yL - highCoefficients.r2g * s.high3 - s.high4) * highCoefficients.h;
+                const auto yB2 = highCoefficients.g * yH2 + s.high3;
+                s.high3 = highCoefficients.g * yH2 + yB2;
+                const auto yL2 = highCoefficients.g * yB2 + s.high4;
+                s.high4 = highCoefficients.g * yB2 + yL2;
+                mid[i] = yL2;
+                high[i] = yL - R2 * yB + yH - yL2;
+            }
+            states[channel] = s;
+        }
+
+    private:
+        struct State {
+            FloatType low1{}, low2{}, low3{}, low4{};
+            FloatType all1{}, all2{};
+            FloatType high1{}, high2{}, high3{}, high4{};
+        };
+
+        struct Coefficients {
+            FloatType g{}, r2g{}, h{};
+        };
+
+        static constexpr FloatType R2 = juce::MathConstants<FloatType>::sqrt2;
+
+        std::vector<State> states;
+        Coefficients lowCoefficients, highCoefficients;
+        double sampleRate = 44100;
+        FloatType lowCutoff = static_cast<FloatType>(240), highCutoff = static_cast<FloatType>(2400);
+
+        Coefficients getCoefficients(FloatType freq) const {
+            const auto g = static_cast<FloatType>(std::tan(juce::MathConstants<double>::pi *
+                                                           static_cast<double>(freq) / sampleRate));
+            return {g, R2 + g, static_cast<FloatType>(1) / (static_cast<FloatType>(1) + R2 * g + g * g)};
+        }
+
+        void update() {
+            lowCoefficients = getCoefficients(lowCutoff);
+            highCoefficients = getCoefficients(highCutoff);
+        }
+    };
+}
+
+#endif //ZLINFLATOR_THREEBANDCROSSOVER_H
@@ -0,0 +1,72 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+#ifndef ZLINFLATOR_TRIPLEBUFFER_H
+#define ZLINFLATOR_TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+
+namespace zldsp {
+    /**
+     * a lock-free single-producer/single-consumer slot
+     * the producer fills getWriteBuffer() and calls publish()
+     * the consumer calls update() and reads getReadBuffer(), which is never touched by the producer
+     * @tparam T
+     */
+    template<typename T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() = default;
+
+        explicit TripleBuffer(const T &initial) {
+            buffers.fill(initial);
+        }
+
+        /**
+         * copy x into all buffers, only call it when neither side is running
+         */
+        void reset(const T &x) {
+            buffers.fill(x);
+            writeIdx = 0;
+            readIdx = 1;
+            middle.store(2, std::memory_order_release);
+        }
+
+        T &getWriteBuffer() { return buffers[writeIdx]; }
+
+        void publish() {
+            writeIdx = middle.exchange(writeIdx | dirtyBit, std::memory_order_acq_rel) & indexMask;
+        }
+
+        /**
+         * @return whether a new buffer has been published since the last call
+         */
+        bool update() {
+            if ((middle.load(std::memory_order_relaxed) & dirtyBit) == 0) {
+                return false;
+            }
+            readIdx = middle.exchange(readIdx, std::memory_order_acq_rel) & indexMask;
+            return true;
+        }
+
+        const T &getReadBuffer() const { return buffers[readIdx]; }
+
+    private:
+        static constexpr int dirtyBit = 4, indexMask = 3;
+        std::array<T, 3> buffers{};
+        int writeIdx = 0, readIdx = 1;
+        std::atomic<int> middle{2};
+    };
+}
+
+#endif //ZLINFLATOR_TRIPLEBUFFER_H
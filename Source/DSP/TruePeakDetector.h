@@ -0,0 +1,106 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#ifndef ZLINFLATOR_TRUEPEAKDETECTOR_H
+#define ZLINFLATOR_TRUEPEAKDETECTOR_H
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace zldsp {
+    /**
+     * the true peak of ITU-R BS.1770-4 Annex 2, 4x oversampling with the 48-tap polyphase FIR of the standard
+     * each phase is one of the interpolated samples, so the oversampled signal is never stored
+     * the phases are computed side by side in the lanes of juce::dsp::SIMDRegister
+     * @tparam FloatType
+     */
+    template<typename FloatType>
+    class TruePeakDetector {
+    public:
+        TruePeakDetector() {
+            // tap k of phase p goes to lane p % width of phaseCoefficients[k][p / width], the spare lanes stay 0
+            for (size_t k = 0; k < numTaps; ++k) {
+                for (size_t b = 0; b < numBlocks; ++b) {
+                    auto reg = SIMDType::expand(0);
+                    for (size_t lane = 0; lane < width && b * width + lane < numPhases; ++lane) {
+                        reg.set(lane, static_cast<FloatType>(coefficients[b * width + lane][k]));
+                    }
+                    phaseCoefficients[k][b] = reg;
+                }
+            }
+        }
+
+        void prepare(size_t numChannels) {
+            histories.resize(numChannels);
+            reset();
+        }
+
+        void reset() {
+            std::fill(histories.begin(), histories.end(), History{});
+        }
+
+        /**
+         * the largest absolute interpolated sample of one channel in the block
+         */
+        template<typename T>
+        FloatType process(size_t channel, const T *data, size_t numSamples) noexcept {
+            auto h = histories[channel];
+            auto peak = SIMDType::expand(0);
+            for (size_t i = 0; i < numSamples; ++i) {
+                // the history is stored twice, so the window of the newest numTaps samples is contiguous
+                h.pos = h.pos == 0 ? numTaps - 1 : h.pos - 1;
+                h.samples[h.pos] = static_cast<FloatType>(data[i]);
+                h.samples[h.pos + numTaps] = h.samples[h.pos];
+                const auto *window = h.samples.data() + h.pos;
+                for (size_t b = 0; b < numBlocks; ++b) {
+                    auto sum = SIMDType::expand(0);
+                    for (size_t k = 0; k < numTaps; ++k) {
+                        sum += phaseCoefficients[k][b] * window[k];
+                    }
+                    peak = SIMDType::max(peak, SIMDType::abs(sum));
+                }
+            }
+            histories[channel] = h;
+            FloatType result = 0;
+            for (size_t lane = 0; lane < width; ++lane) {
+                result = juce::jmax(result, peak.get(lane));
+            }
+            return result;
+        }
+
+    private:
+        using SIMDType = juce::dsp::SIMDRegister<FloatType>;
+        static constexpr size_t numPhases = 4, numTaps = 12;
+        static constexpr size_t width = SIMDType::SIMDNumElements, numBlocks = (numPhases + width - 1) / width;
+
+        struct History {
+            std::array<FloatType, 2 * numTaps> samples{};
+            size_t pos = 0;
+        };
+
+        static constexpr std::array<std::array<double, numTaps>, numPhases> coefficients{{
+            {0.0017089843750, 0.0109863281250, -0.0196533203125, 0.0332031250000, -0.0594482421875, 0.1373291015625,
+             0.9721679687500, -0.1022949218750, 0.0476074218750, -0.0266113281250, 0.0148925781250, -0.0083007812500},
+            {-0.0291748046875, 0.0292968750000, -0.0517578125000, 0.0891113281250, -0.1665039062500, 0.4650878906250,
+             0.7797851562500, -0.2003173828125, 0.1015625000000, -0.0582275390625, 0.0330810546875, -0.0189208984375},
+            {-0.0189208984375, 0.0330810546875, -0.0582275390625, 0.1015625000000, -0.2003173828125, 0.7797851562500,
+             0.4650878906250, -0.1665039062500, 0.0891113281250, -0.0517578125000, 0.0292968750000, -0.0291748046875},
+            {-0.0083007812500, 0.0148925781250, -0.0266113281250, 0.0476074218750, -0.1022949218750, 0.9721679687500,
+             0.1373291015625, -0.0594482421875, 0.0332031250000, -0.0196533203125, 0.0109863281250, 0.0017089843750}
+        }};
+
+        std::array<std::array<SIMDType, numBlocks>, numTaps> phaseCoefficients;
+        std::vector<History> histories;
+    };
+}
+
+#endif //ZLINFLATOR_TRUEPEAKDETECTOR_H
@@ -18,35 +18,91 @@ You should have received a copy of the GNU General Public License along with ZLI
 #include "juce_audio_processors/juce_audio_processors.h"
 #include "juce_dsp/juce_dsp.h"
 #include "ShaperFunctions.h"
+#include "ShaperTable.h"
+#include "StageLoad.h"
+#include "ThreeBandCrossover.h"
+#include "TripleBuffer.h"
+#include "WaveShaperState.h"
 
 template<typename FloatType>
 class WaveHelper {
 public:
-    WaveHelper() {
-        setWet(static_cast<FloatType>(zldsp::wet::formatV(zldsp::wet::defaultV)));
+    /**
+     * set the shaping of the next block, called on the audio thread once per block
+     * across the block wet moves from wetStart to wetEnd and the curve from previous to mixer
+     * a null previous keeps the curve still
+     */
+    void setParameters(const shaper::ShaperMixer<FloatType> &mixer, const shaper::ShaperMixer<FloatType> *previous,
+                       shaper::ShaperTable<FloatType> *table, FloatType wetStart, FloatType wetEnd) {
+        shaperMixer = &mixer;
+        previousMixer = previous;
+        shaperTable = table;
+        m_wetStart = wetStart;
+        m_wet = wetEnd;
+        m_dry = static_cast<FloatType>(1) - wetEnd;
     }
 
-    void setWet(FloatType wet) {
-        m_wet = wet;
-        m_dry = static_cast<FloatType>(1) - wet;
-    }
+    FloatType operator()(FloatType x) const { return shape(x); }
 
-    void setShapes(FloatType curve1, FloatType curve2, FloatType weight, bool compensation) {
-        shaperMixer.setShapes(curve1, curve2, weight, compensation);
+    void processBlock(const FloatType *in, FloatType *out, size_t numSamples) {
+        processBlock(in, out, numSamples, 0, numSamples);
     }
 
-    void setTypes(size_t type1, size_t type2) {
-        shaperMixer.setTypes(type1, type2);
+    /**
+     * process the samples [offset, offset + numSamples) of a block with totalSamples samples
+     * the ramps continue across the calls, so a block can be shaped chunk by chunk
+     */
+    void processBlock(const FloatType *in, FloatType *out, size_t numSamples, size_t offset, size_t totalSamples) {
+        const auto total = static_cast<FloatType>(totalSamples);
+        const auto rampStart = static_cast<FloatType>(offset) / total;
+        const auto rampEnd = static_cast<FloatType>(offset + numSamples) / total;
+        const auto wetStart = m_wetStart + (m_wet - m_wetStart) * rampStart;
+        const auto wetEnd = m_wetStart + (m_wet - m_wetStart) * rampEnd;
+        if (shaperTable != nullptr) {
+            shaperTable->process(in, out, numSamples, wetStart, wetEnd);
+        } else if (previousMixer != nullptr) {
+            shaperMixer->processRamp(*previousMixer, in, out, numSamples, wetStart, wetEnd, rampStart, rampEnd);
+        } else {
+            shaperMixer->process(in, out, numSamples, wetStart, wetEnd);
+        }
     }
 
-    FloatType operator()(FloatType x) const { return shape(x); }
+    /**
+     * shape numChannels channels in place with one gain per sample, taken from the peak across channels
+     * so the balance between the channels is kept, peak and gain are scratch space of numSamples samples
+     */
+    void processLinked(FloatType *const *channels, size_t numChannels, size_t numSamples, size_t offset,
+                       size_t totalSamples, FloatType *peak, FloatType *gain) {
+        std::fill(peak, peak + numSamples, static_cast<FloatType>(0));
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            for (size_t i = 0; i < numSamples; ++i) {
+                peak[i] = juce::jmax(peak[i], std::abs(channels[ch][i]));
+            }
+        }
+        processBlock(peak, gain, numSamples, offset, totalSamples);
+        for (size_t i = 0; i < numSamples; ++i) {
+            gain[i] = peak[i] > linkFloor ? gain[i] / peak[i] : static_cast<FloatType>(1);
+        }
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            juce::FloatVectorOperations::multiply(channels[ch], gain, static_cast<int>(numSamples));
+        }
+    }
 
-    shaper::ShaperMixer<FloatType> *getShaper() { return &shaperMixer; }
+    template<typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType> &inBlock,
+                 const juce::dsp::AudioBlock<SampleType> &outBlock) {
+        for (size_t ch = 0; ch < inBlock.getNumChannels(); ++ch) {
+            processBlock(inBlock.getChannelPointer(ch), outBlock.getChannelPointer(ch), inBlock.getNumSamples());
+        }
+    }
 
 private:
     static constexpr FloatType clip = static_cast<FloatType>(1);
-    std::atomic<FloatType> m_wet, m_dry;
-    shaper::ShaperMixer<FloatType> shaperMixer;
+    // below it the linked gain is left at unity, -120 dB
+    static constexpr FloatType linkFloor = static_cast<FloatType>(1e-6);
+    const shaper::ShaperMixer<FloatType> *shaperMixer = nullptr, *previousMixer = nullptr;
+    shaper::ShaperTable<FloatType> *shaperTable = nullptr;
+    FloatType m_wetStart = 1, m_wet = 1, m_dry = 0;
 
     static FloatType sgn(FloatType x) {
         if (x > 0) {
@@ -57,298 +113,809 @@ private:
     }
 
     FloatType shape(FloatType x) const {
-        return shaperMixer(juce::jmin(static_cast<FloatType>(1), std::abs(x))) * m_wet * sgn(x) + x * m_dry;
+        return (*shaperMixer)(juce::jmin(static_cast<FloatType>(1), std::abs(x))) * m_wet * sgn(x) + x * m_dry;
     }
 };
 
+/**
+ * oversampled wave shaper with an optional 3-band split and mid/side mode
+ * the parameters come from a WaveShaperState shared with the other shapers, the audio thread reads a
+ * snapshot of it at the top of each block, the lookup tables and the oversamplers follow on the message thread
+ * only the selected oversampler is allocated: it is built on the message thread and handed to
+ * the audio thread through an atomic slot, the previous one is freed once the audio thread lets go of it
+ * with constant latency on, every factor is delayed to the latency of the slowest one, and a new
+ * oversampler is warmed up next to the old one and then crossfaded in
+ * @tparam FloatType
+ */
 template<typename FloatType>
-class LRFilters {
+class WaveShaper : private WaveShaperState::Listener, private juce::Timer {
 public:
-    LRFilters() {
-        filters[0].setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-        filters[1].setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-        filters[2].setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+    constexpr static const size_t maxChannels = 16;
+
+    explicit WaveShaper(juce::AudioProcessor &processor, WaveShaperState &parameterState) {
+        processorRef = &processor;
+        state = &parameterState;
+        resetSmoothers(44100);
+        state->addListener(this);
+        loadParameters(true);
     }
 
-    void setCutoffFrequency(float freq) {
-        if (!juce::approximatelyEqual(freq, filters[0].getCutoffFrequency())) {
-            for (auto &f: filters) {
-                f.setCutoffFrequency(freq);
-            }
-        }
+    ~WaveShaper() override {
+        state->removeListener(this);
+        stopTimer();
     }
 
-    void reset() {
-        for (auto &f: filters) {
-            f.reset();
+    void reset() noexcept {
+        for (auto &path: paths) {
+            path.crossover.reset();
+            path.delay.reset();
+        }
+        if (paths[activePath].sampler != nullptr) {
+            paths[activePath].sampler->reset();
         }
     }
 
-    void update(const int factor) {
-        auto rate = static_cast<int> (std::pow(2.0, factor));
-        juce::dsp::ProcessSpec spec{dupSpec.sampleRate * rate,
-                                    dupSpec.numChannels,
-                                    dupSpec.maximumBlockSize * static_cast<unsigned int>(rate)};
-        for (auto &f: filters) {
-            f.prepare(spec);
+    /**
+     * approximate heap memory held by this instance in bytes
+     * call it on the message thread, it also frees oversamplers the audio thread no longer uses
+     */
+    size_t getMemoryUsage() {
+        const juce::ScopedLock lock(samplerLock);
+        retireSamplers();
+        const auto channels = static_cast<size_t>(samplerSpec.numChannels);
+        size_t bytes = channels * samplerSpec.maximumBlockSize * sizeof(FloatType) +
+                       linkBuffer.capacity() * sizeof(FloatType);
+        for (auto &path: paths) {
+            bytes += path.crossover.getMemoryUsage() + channels * (maxLatency + 1) * sizeof(FloatType);
+        }
+        for (auto &shape: shapes) {
+            if (shape.table != nullptr) {
+                bytes += sizeof(shaper::ShaperTable<FloatType>);
+            }
         }
+        for (size_t slot = 0; slot < numSlots; ++slot) {
+            if (overSamplers[slot] != nullptr) {
+                // the stage buffers dominate: channels * block size * (2 + 4 + ... + 2^i)
+                bytes += channels * samplerSpec.maximumBlockSize * sizeof(FloatType) *
+                         ((static_cast<size_t>(2) << (slot % numSamplers)) - 2);
+            }
+        }
+        return bytes;
     }
 
-    void prepare(const juce::dsp::ProcessSpec &spec) {
-        for (auto &f: filters) {
-            f.prepare(spec);
+    /** latency in samples of the requested oversampler, without the constant latency delay */
+    int getSamplerLatency() const {
+        return samplerLatency.load();
+    }
+
+    /**
+     * time spent in the up and down sampling filters, as a fraction of the block duration
+     * smoothed over recent blocks
+     */
+    float getSamplerLoad() const {
+        return samplerLoad.load(std::memory_order_relaxed);
+    }
+
+    /** before prepare(): the shaper only runs while channel link is on, so it builds its oversamplers only then */
+    void setLinkOnly(bool shouldBeLinkOnly) {
+        linkOnly = shouldBeLinkOnly;
+    }
+
+    /**
+     * audio thread: pick up the latest snapshot and oversampler, and tell whether there is one to process with
+     * a link-only shaper has none until the message thread has built it for channel link
+     */
+    bool isReady() {
+        loadParameters(false);
+        switchSampler();
+        return paths[activePath].sampler != nullptr;
+    }
+
+    /** audio thread: let go of the oversamplers while the shaper is not used, so the message thread can free them */
+    void idle() {
+        for (auto &path: paths) {
+            path.sampler = nullptr;
         }
-        dupSpec.sampleRate = spec.sampleRate;
-        dupSpec.numChannels = spec.numChannels;
-        dupSpec.maximumBlockSize = spec.maximumBlockSize;
+        switching = false;
+        samplersInUse.store(0);
     }
 
-    template<typename ProcessContext>
-    void processLow(ProcessContext &context) {
-        filters[0].process(context);
+    /** audio thread: the oversampling factor of the oversampler in use, which may differ from the parameter */
+    size_t getActiveFactor() const {
+        return static_cast<size_t>(1) << paths[activePath].idx;
     }
 
-    template<typename ProcessContext>
-    void processHigh(ProcessContext &context) {
-        filters[1].process(context);
+    /**
+     * audio thread: whether the crossover and the shaper are timed apart, the oversamplers are always timed
+     * the ticks collected so far are dropped
+     */
+    void setStageTiming(bool shouldTime) {
+        stageTiming = shouldTime;
+        stageTicks.fill(0);
+    }
+
+    /** audio thread: the ticks spent in each stage since the last call, while stage timing is on */
+    zldsp::StageLoad::Ticks takeStageTicks() {
+        const auto ticks = stageTicks;
+        stageTicks.fill(0);
+        return ticks;
+    }
+
+    template<typename SampleType>
+    SampleType JUCE_VECTOR_CALLTYPE
+    processSample(SampleType s) noexcept {
+        return shapes[midShape].helper(s);
     }
 
+    //==============================================================================
     template<typename ProcessContext>
-    void processAll(ProcessContext &context) {
-        filters[2].process(context);
+    void process(const ProcessContext &context) noexcept {
+        loadParameters(false);
+        switchSampler();
+        const auto numSamples = context.getInputBlock().getNumSamples();
+        updateShapes(numSamples);
+        if (context.usesSeparateInputAndOutputBlocks())
+            context.getOutputBlock().copyFrom(context.getInputBlock());
+        if (context.isBypassed || paths[activePath].sampler == nullptr) {
+            return;
+        }
+        auto block = context.getOutputBlock();
+        blockTicks.fill(0);
+        // the encoding is linear, so it can stay at the base rate, outside of the oversampler
+        midSideActive = current.midSide && block.getNumChannels() == 2;
+        if (midSideActive) {
+            encodeMidSide(block);
+        }
+        if (!switching) {
+            processPath(paths[activePath], block);
+        } else {
+            processSwitch(block);
+        }
+        if (midSideActive) {
+            decodeMidSide(block);
+        }
+        updateLoad(blockTicks[zldsp::StageLoad::upSampling] + blockTicks[zldsp::StageLoad::downSampling],
+                   numSamples);
+        if (stageTiming) {
+            for (size_t i = 0; i < stageTicks.size(); ++i) {
+                stageTicks[i] += blockTicks[i];
+            }
+        }
     }
 
-private:
-    std::array<juce::dsp::LinkwitzRileyFilter<FloatType>, 3> filters{};
-    juce::dsp::LinkwitzRileyFilter<FloatType> low, high, all;
-    juce::dsp::ProcessSpec dupSpec{44100, 0, 2};
-};
+    void prepare(const juce::dsp::ProcessSpec &spec) {
+        reset();
+        sampleRate = spec.sampleRate;
+        resetSmoothers(spec.sampleRate);
+        jassert(spec.numChannels <= maxChannels);
+        switchBuffer.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
+        linkBuffer.resize(spec.numChannels * numBands * maxChunkSize);
+        {
+            // the audio thread is stopped, so every oversampler can go
+            const juce::ScopedLock lock(samplerLock);
+            samplerSpec = spec;
+            samplersInUse.store(0);
+            for (size_t slot = 0; slot < numSlots; ++slot) {
+                samplerSlots[slot].store(nullptr);
+                overSamplers[slot].reset();
+            }
+            // the latencies do not depend on the sample rate or the block size, so tiny probes will do
+            maxLatency = 0;
+            for (size_t slot = 0; slot < numSlots; ++slot) {
+                slotLatencies[slot] = static_cast<size_t>(createSampler(1, slot, 1)->getLatencyInSamples());
+                maxLatency = juce::jmax(maxLatency, slotLatencies[slot]);
+            }
+        }
+        switching = false;
+        for (auto &path: paths) {
+            path.sampler = nullptr;
+            path.crossover.prepare(spec);
+            path.delay.setMaximumDelayInSamples(static_cast<int>(maxLatency));
+            path.delay.prepare(spec);
+        }
+        updateSamplers();
+        tablesChanged();
+        loadParameters(true);
+    }
 
-template<typename FloatType>
-class WaveShaper {
-public:
-    explicit WaveShaper(juce::AudioProcessor &processor) {
-        processorRef = &processor;
-        filters[0].setCutoffFrequency(zldsp::lowSplit::defaultV);
-        filters[1].setCutoffFrequency(zldsp::highSplit::defaultV);
+    /**
+     * free the oversamplers and stop reporting latency, until the next prepare()
+     * the audio thread must be stopped
+     */
+    void release() {
+        {
+            const juce::ScopedLock lock(samplerLock);
+            samplerSpec.numChannels = 0;
+            samplersInUse.store(0);
+            for (size_t slot = 0; slot < numSlots; ++slot) {
+                samplerSlots[slot].store(nullptr);
+                overSamplers[slot].reset();
+            }
+        }
+        stopTimer();
+        switching = false;
+        for (auto &path: paths) {
+            path.sampler = nullptr;
+        }
+        switchBuffer.setSize(0, 0);
+        linkBuffer.clear();
+        linkBuffer.shrink_to_fit();
     }
 
-    shaper::ShaperMixer<FloatType> *getShaper() { return helper.getShaper(); }
+private:
+    /** an oversampler together with the state that depends on its rate */
+    struct SamplerPath {
+        juce::dsp::Oversampling<FloatType> *sampler = nullptr;
+        size_t idx = zldsp::overSample::defaultI, slot = idx;
+        zldsp::ThreeBandCrossover<FloatType> crossover;
+        // brings the latency up to the one reported to the host
+        juce::dsp::DelayLine<FloatType, juce::dsp::DelayLineInterpolationTypes::None> delay;
+        size_t delaySamples = 0;
+    };
 
-    void setWet(FloatType wet) {
-        helper.setWet(wet);
+    juce::AudioProcessor *processorRef;
+    constexpr static const int numSamplers = 5, numQualities = zldsp::overSampleQuality::qualityNUM, numBands = 3;
+    // one oversampler per factor and filter quality
+    constexpr static const size_t numSlots = numSamplers * numQualities;
+    // ramp length of the smoothed parameters, and how often (in samples) the split cutoffs follow their ramps
+    constexpr static const double smoothSeconds = 0.05;
+    constexpr static const size_t cutoffInterval = 32;
+    // length of the crossfade between two oversamplers
+    constexpr static const double crossfadeSeconds = 0.02;
+    // weight of the latest block in the smoothed oversampler load
+    constexpr static const float loadSmoothing = 0.1f;
+    // how often (in ms) the message thread checks whether a replaced oversampler can be freed
+    constexpr static const int retireInterval = 50;
+    // the split path works in chunks of cutoffInterval input samples, which stay in L1 at 16x
+    constexpr static const size_t maxChunkSize = cutoffInterval << (numSamplers - 1);
+    std::atomic<double> sampleRate{44100};
+    // message side: the oversamplers and the tables that exist, guarded by samplerLock
+    juce::CriticalSection samplerLock;
+    juce::dsp::ProcessSpec samplerSpec{44100, 0, 0};
+    size_t requestedSlot = zldsp::overSample::defaultI;
+    // a shaper that only serves linked mode holds no oversampler while channel link is off
+    bool linkOnly = false;
+    std::array<std::unique_ptr<juce::dsp::Oversampling<FloatType>>, numSlots> overSamplers{};
+    // shared: the oversamplers handed to the audio thread, and a bit for each one it may be using
+    std::array<std::atomic<juce::dsp::Oversampling<FloatType> *>, numSlots> samplerSlots{};
+    std::atomic<uint32_t> samplersInUse{0};
+    std::atomic<int> samplerLatency{0};
+    std::atomic<float> samplerLoad{0.f};
+    // audio side: the ticks of the current block, and of the blocks since takeStageTicks()
+    zldsp::StageLoad::Ticks blockTicks{}, stageTicks{};
+    bool stageTiming = false;
+    // latency of every oversampler and of the slowest one, set in prepare()
+    std::array<size_t, numSlots> slotLatencies{};
+    size_t maxLatency = 0;
+    alignas(16) std::array<std::array<FloatType, maxChunkSize>, numBands> bandBuffers{};
+    // linked mode: the bands of every channel, and the peak and gain of a chunk
+    std::vector<FloatType> linkBuffer;
+    alignas(16) std::array<FloatType, maxChunkSize> linkPeak{}, linkGain{};
+
+    // shared with the other shapers of the processor
+    WaveShaperState *state;
+    // audio side: the snapshot in use and the state derived from it
+    WaveShaperParameters<FloatType> current;
+    // the merged snapshots, published under the update lock of the state and picked up whole by the audio thread
+    zldsp::TripleBuffer<WaveShaperParameters<FloatType>> parameterSlot;
+    std::array<SamplerPath, 2> paths;
+    size_t activePath = 0;
+    // while switching, the other path warms up and then fades in
+    bool switching = false;
+    size_t warmupRemaining = 0, fadePosition = 0, fadeLength = 1;
+    juce::AudioBuffer<FloatType> switchBuffer;
+    /** the shaping of one channel role, the mid (or every) channel, or the side channel */
+    struct ShapeState {
+        WaveHelper<FloatType> helper;
+        shaper::ShaperMixer<FloatType> mixer, previousMixer;
+        // allocated and built on the message thread when table mode is first enabled,
+        // tableSlot hands it to the audio thread once it holds a curve
+        std::unique_ptr<shaper::ShaperTable<FloatType>> table;
+        std::atomic<shaper::ShaperTable<FloatType> *> tableSlot{nullptr};
+        juce::SmoothedValue<FloatType> wet, curve1, curve2;
+    };
+    constexpr static const size_t midShape = 0, sideShape = 1;
+    std::array<ShapeState, 2> shapes;
+    bool midSideActive = false;
+    juce::SmoothedValue<FloatType> weightSmoother;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowSmoother, highSmoother;
+
+    /** build the lookup tables for the target curves, on the message thread, only while table mode is on */
+    void tablesChanged() override {
+        const juce::ScopedLock lock(samplerLock);
+        const auto p = state->getParameters<FloatType>();
+        if (!p.table) {
+            return;
+        }
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            auto &shape = shapes[i];
+            if (shape.table == nullptr) {
+                shape.table = std::make_unique<shaper::ShaperTable<FloatType>>();
+            }
+            const auto targets = getShapeTargets(p, i);
+            shaper::ShaperMixer<FloatType> tableMixer;
+            tableMixer.setShapes(targets[1], targets[2], p.weight, p.compensation);
+            tableMixer.setTypes(p.type1, p.type2);
+            shape.table->build(tableMixer);
+            shape.tableSlot.store(shape.table.get(), std::memory_order_release);
+        }
     }
 
-    void setShapes(FloatType curve1, FloatType curve2, FloatType weight, bool compensation) {
-        helper.setShapes(curve1, curve2, weight, compensation);
+    void samplersChanged() override {
+        updateSamplers();
     }
 
-    void setCutoffFrequency(FloatType lowFreq, FloatType highFreq) {
-        const juce::GenericScopedLock<juce::CriticalSection> processLock(processorRef->getCallbackLock());
-        filters[0].setCutoffFrequency(lowFreq);
-        filters[1].setCutoffFrequency(highFreq);
+    void parametersChanged() override {
+        parameterSlot.getWriteBuffer() = state->getParameters<FloatType>();
+        parameterSlot.publish();
     }
 
-    void setEffectFlag(bool effectFlag) {
-        effect = effectFlag;
+    /** wet, curve1 and curve2 of the mid (or every) channel, or of the side channel */
+    static std::array<FloatType, 3> getShapeTargets(const WaveShaperParameters<FloatType> &p, size_t index) {
+        if (index == midShape) {
+            return {p.wet, p.curve1, p.curve2};
+        }
+        return {p.sideWet, p.sideCurve1, p.sideCurve2};
     }
 
-    void setSplitFlag(bool splitFlag) {
-        split = splitFlag;
+    void resetSmoothers(double rate) {
+        for (auto &shape: shapes) {
+            for (auto *s: {&shape.wet, &shape.curve1, &shape.curve2}) {
+                s->reset(rate, smoothSeconds);
+            }
+        }
+        weightSmoother.reset(rate, smoothSeconds);
+        for (auto *s: {&lowSmoother, &highSmoother}) {
+            s->reset(rate, smoothSeconds);
+        }
     }
 
-    void setOverSampleFactor(int overSampleFactor) {
-        const juce::GenericScopedLock<juce::CriticalSection> processLock(processorRef->getCallbackLock());
-        idxSampler = static_cast<size_t>(std::min(overSampleFactor, numSamplers - 1));
-        for (size_t i = 0; i < numBands - 1; ++i) {
-            filters[i].update(overSampleFactor);
+    /**
+     * advance the shaping ramps by one block and hand them to the helper
+     * the kernels interpolate wet and the curve per sample, so no block slicing is needed
+     */
+    void updateShapes(size_t numSamples) {
+        const auto n = static_cast<int>(numSamples);
+        const auto weightRamp = weightSmoother.isSmoothing();
+        const auto weight = weightSmoother.skip(n);
+        for (auto &shape: shapes) {
+            const auto wetStart = shape.wet.getCurrentValue();
+            const auto wetEnd = shape.wet.skip(n);
+            const auto ramp = weightRamp || shape.curve1.isSmoothing() || shape.curve2.isSmoothing();
+            if (ramp) {
+                shape.previousMixer = shape.mixer;
+                shape.mixer.setShapes(shape.curve1.skip(n), shape.curve2.skip(n), weight, current.compensation);
+            }
+            // the table always holds the target curve, so only wet ramps in table mode
+            // until the message thread has built it, the analytic kernels stand in
+            shape.helper.setParameters(shape.mixer, ramp ? &shape.previousMixer : nullptr,
+                                       current.table ? shape.tableSlot.load(std::memory_order_acquire) : nullptr,
+                                       wetStart, wetEnd);
         }
-        processorRef->setLatencySamples(static_cast<int>(overSamplers[idxSampler]->getLatencyInSamples()));
     }
 
-    void setTypes(size_t type1, size_t type2) {
-        helper.setTypes(type1, type2);
+    /** in mid/side mode, the side channel has its own helper */
+    WaveHelper<FloatType> &getHelper(size_t channel) {
+        return shapes[midSideActive && channel == 1 ? sideShape : midShape].helper;
     }
 
-    void reset() noexcept {
-        for (size_t i = 0; i < numBands - 1; ++i) {
-            filters[i].reset();
+    static void encodeMidSide(juce::dsp::AudioBlock<FloatType> &block) {
+        auto *left = block.getChannelPointer(0);
+        auto *right = block.getChannelPointer(1);
+        for (size_t i = 0; i < block.getNumSamples(); ++i) {
+            const auto m = (left[i] + right[i]) * static_cast<FloatType>(0.5);
+            right[i] = (left[i] - right[i]) * static_cast<FloatType>(0.5);
+            left[i] = m;
         }
-        for (size_t i = 0; i < numSamplers; i++) {
-            if (overSamplers[i] != nullptr)
-                overSamplers[i]->reset();
+    }
+
+    static void decodeMidSide(juce::dsp::AudioBlock<FloatType> &block) {
+        auto *m = block.getChannelPointer(0);
+        auto *s = block.getChannelPointer(1);
+        for (size_t i = 0; i < block.getNumSamples(); ++i) {
+            const auto left = m[i] + s[i];
+            s[i] = m[i] - s[i];
+            m[i] = left;
         }
     }
 
-    template<typename SampleType>
-    SampleType JUCE_VECTOR_CALLTYPE
-    processSample(SampleType s) noexcept {
-        return helper(s);
+    /** both oversamplers run while the new one warms up and fades in */
+    void processSwitch(juce::dsp::AudioBlock<FloatType> &block) {
+        const auto numSamples = block.getNumSamples();
+        auto nextBlock = juce::dsp::AudioBlock<FloatType>(switchBuffer)
+                .getSubsetChannelBlock(0, block.getNumChannels()).getSubBlock(0, numSamples);
+        nextBlock.copyFrom(block);
+        const auto lowState = lowSmoother;
+        const auto highState = highSmoother;
+        processPath(paths[activePath], block);
+        lowSmoother = lowState;
+        highSmoother = highState;
+        processPath(paths[1 - activePath], nextBlock);
+        crossfade(block, nextBlock);
     }
 
-    //==============================================================================
-    template<typename ProcessContext>
-    void process(const ProcessContext &context) noexcept {
-        const auto numSamples = context.getInputBlock().getNumSamples();
-        const auto numChannels = context.getInputBlock().getNumChannels();
-        if (context.isBypassed) {
-            if (context.usesSeparateInputAndOutputBlocks())
-                context.getOutputBlock().copyFrom(context.getInputBlock());
+    /** oversample, shape and downsample the block in place with the oversampler of path */
+    void processPath(SamplerPath &path, juce::dsp::AudioBlock<FloatType> &block) {
+        const auto numSamples = block.getNumSamples();
+        // the oversamplers are always timed for getSamplerLoad, the bands only with stage timing
+        zldsp::StageLoad::Clock clock(blockTicks, true);
+        auto oversampledBlock = path.sampler->processSamplesUp(block);
+        clock.lap(zldsp::StageLoad::upSampling);
+        if (current.split) {
+            processSplit(path, oversampledBlock, numSamples, stageTiming ? &clock : nullptr);
+            if (!stageTiming) {
+                clock.restart();
+            }
         } else {
-            auto oversampled_block =
-                    overSamplers[idxSampler]->processSamplesUp(context.getInputBlock());
-            auto oversampled_context =
-                    juce::dsp::ProcessContextReplacing<FloatType>(oversampled_block);
-            if (split) {
-                auto sepBlock =
-                        juce::dsp::AudioBlock<FloatType>(bufferSeparation)
-                                .getSubBlock(0, static_cast<size_t> (
-                                        std::pow(FloatType(2), static_cast<FloatType>(idxSampler)) *
-                                        static_cast<FloatType>(numSamples)));
-                juce::dsp::AudioBlock<FloatType> blocks[numBands];
-                std::vector<juce::dsp::ProcessContextReplacing<FloatType>> contexts;
-                for (size_t i = 0; i < numBands; ++i) {
-                    blocks[i] = sepBlock.getSubsetChannelBlock(i * numChannels,
-                                                               (size_t) numChannels);
-                    blocks[i].copyFrom(oversampled_context.getInputBlock());
-                    contexts.push_back(
-                            juce::dsp::ProcessContextReplacing<FloatType>(blocks[i]));
+            lowSmoother.skip(static_cast<int>(numSamples));
+            highSmoother.skip(static_cast<int>(numSamples));
+            if (current.effect && isLinked(oversampledBlock)) {
+                processLinked(oversampledBlock);
+            } else if (current.effect) {
+                for (size_t ch = 0; ch < oversampledBlock.getNumChannels(); ++ch) {
+                    auto *data = oversampledBlock.getChannelPointer(ch);
+                    getHelper(ch).processBlock(data, data, oversampledBlock.getNumSamples());
                 }
+            }
+            clock.lap(zldsp::StageLoad::shaper);
+        }
+        path.sampler->processSamplesDown(block);
+        clock.lap(zldsp::StageLoad::downSampling);
+        if (path.delaySamples > 0) {
+            path.delay.process(juce::dsp::ProcessContextReplacing<FloatType>(block));
+        }
+    }
 
-                filters[0].processLow(contexts[0]);
-                filters[1].processAll(contexts[0]);
-
-                filters[0].processHigh(contexts[1]);
-                contexts[2].getOutputBlock().copyFrom(contexts[1].getOutputBlock());
+    static void lap(zldsp::StageLoad::Clock *clock, zldsp::StageLoad::Stage stage) {
+        if (clock != nullptr) {
+            clock->lap(stage);
+        }
+    }
 
-                filters[1].processLow(contexts[1]);
-                filters[1].processHigh(contexts[2]);
+    void updateLoad(juce::int64 ticks, size_t numSamples) {
+        const auto load = static_cast<float>(juce::Time::highResolutionTicksToSeconds(ticks) * sampleRate /
+                                             static_cast<double>(numSamples));
+        const auto previous = samplerLoad.load(std::memory_order_relaxed);
+        samplerLoad.store(previous + (load - previous) * loadSmoothing, std::memory_order_relaxed);
+    }
 
-                if (effect.load()) {
-                    for (size_t i = 0; i < numBands; ++i) {
-                        juce::dsp::AudioBlock<FloatType>::process(
-                                contexts[i].getInputBlock(), contexts[i].getOutputBlock(),
-                                helper);
+    /**
+     * split, shape and sum the bands chunk by chunk, so each sample is read and written once
+     * while a cutoff ramps, the crossover is updated every cutoffInterval samples
+     * with a clock, the crossover and the shaping are timed apart, the sum of the bands counts as crossover
+     */
+    void processSplit(SamplerPath &path, const juce::dsp::AudioBlock<FloatType> &block, size_t numSamples,
+                      zldsp::StageLoad::Clock *clock) {
+        if (isLinked(block)) {
+            processLinkedSplit(path, block, numSamples, clock);
+            return;
+        }
+        const auto factor = static_cast<size_t>(1) << path.idx;
+        const auto totalSamples = block.getNumSamples();
+        auto &[low, mid, high] = bandBuffers;
+        for (size_t start = 0; start < numSamples;) {
+            const auto length = juce::jmin(cutoffInterval, numSamples - start);
+            path.crossover.setCutoffFrequencies(
+                    static_cast<FloatType>(lowSmoother.skip(static_cast<int>(length))),
+                    static_cast<FloatType>(highSmoother.skip(static_cast<int>(length))));
+            const auto offset = start * factor;
+            const auto chunkSize = length * factor;
+            for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+                auto *data = block.getChannelPointer(ch) + offset;
+                path.crossover.process(ch, data, low.data(), mid.data(), high.data(), chunkSize);
+                lap(clock, zldsp::StageLoad::crossover);
+                if (current.effect) {
+                    for (auto *band: {low.data(), mid.data(), high.data()}) {
+                        getHelper(ch).processBlock(band, band, chunkSize, offset, totalSamples);
                     }
                 }
+                lap(clock, zldsp::StageLoad::shaper);
+                for (size_t i = 0; i < chunkSize; ++i) {
+                    data[i] = low[i] + mid[i] + high[i];
+                }
+                lap(clock, zldsp::StageLoad::crossover);
+            }
+            start += length;
+        }
+    }
 
-                for (size_t i = 1; i < numBands; ++i) {
-                    blocks[0].add(blocks[i]);
+    /** mid and side are not linked, their levels have no common scale */
+    bool isLinked(const juce::dsp::AudioBlock<FloatType> &block) const {
+        return current.link && !midSideActive && block.getNumChannels() > 1;
+    }
+
+    void processLinked(const juce::dsp::AudioBlock<FloatType> &block) {
+        const auto numChannels = block.getNumChannels();
+        const auto totalSamples = block.getNumSamples();
+        std::array<FloatType *, maxChannels> channels{};
+        for (size_t offset = 0; offset < totalSamples; offset += maxChunkSize) {
+            const auto chunkSize = juce::jmin(maxChunkSize, totalSamples - offset);
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                channels[ch] = block.getChannelPointer(ch) + offset;
+            }
+            shapes[midShape].helper.processLinked(channels.data(), numChannels, chunkSize, offset,
+                                                  totalSamples, linkPeak.data(), linkGain.data());
+        }
+    }
+
+    /** the split path of the linked mode, each band is linked across the channels on its own */
+    void processLinkedSplit(SamplerPath &path, const juce::dsp::AudioBlock<FloatType> &block, size_t numSamples,
+                            zldsp::StageLoad::Clock *clock) {
+        const auto factor = static_cast<size_t>(1) << path.idx;
+        const auto numChannels = block.getNumChannels();
+        const auto totalSamples = block.getNumSamples();
+        auto getBand = [&](size_t ch, size_t band) {
+            return linkBuffer.data() + (ch * numBands + band) * maxChunkSize;
+        };
+        std::array<FloatType *, maxChannels> channels{};
+        for (size_t start = 0; start < numSamples;) {
+            const auto length = juce::jmin(cutoffInterval, numSamples - start);
+            path.crossover.setCutoffFrequencies(
+                    static_cast<FloatType>(lowSmoother.skip(static_cast<int>(length))),
+                    static_cast<FloatType>(highSmoother.skip(static_cast<int>(length))));
+            const auto offset = start * factor;
+            const auto chunkSize = length * factor;
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                path.crossover.process(ch, block.getChannelPointer(ch) + offset,
+                                       getBand(ch, 0), getBand(ch, 1), getBand(ch, 2), chunkSize);
+            }
+            lap(clock, zldsp::StageLoad::crossover);
+            if (current.effect) {
+                for (size_t band = 0; band < numBands; ++band) {
+                    for (size_t ch = 0; ch < numChannels; ++ch) {
+                        channels[ch] = getBand(ch, band);
+                    }
+                    shapes[midShape].helper.processLinked(channels.data(), numChannels, chunkSize, offset,
+                                                          totalSamples, linkPeak.data(), linkGain.data());
                 }
+            }
+            lap(clock, zldsp::StageLoad::shaper);
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                auto *data = block.getChannelPointer(ch) + offset;
+                const auto *low = getBand(ch, 0), *mid = getBand(ch, 1), *high = getBand(ch, 2);
+                for (size_t i = 0; i < chunkSize; ++i) {
+                    data[i] = low[i] + mid[i] + high[i];
+                }
+            }
+            lap(clock, zldsp::StageLoad::crossover);
+            start += length;
+        }
+    }
 
-                oversampled_context.getOutputBlock().copyFrom(blocks[0]);
-            } else {
-                if (effect.load()) {
-                    juce::dsp::AudioBlock<FloatType>::process(
-                            oversampled_context.getInputBlock(),
-                            oversampled_context.getOutputBlock(), helper);
+    /**
+     * mix the new path into block, after the warm-up it fades in linearly
+     * once the fade is complete, the new path becomes the active one
+     */
+    void crossfade(juce::dsp::AudioBlock<FloatType> &block, const juce::dsp::AudioBlock<FloatType> &nextBlock) {
+        const auto numSamples = block.getNumSamples();
+        const auto warmup = juce::jmin(warmupRemaining, numSamples);
+        const auto step = static_cast<FloatType>(1) / static_cast<FloatType>(fadeLength);
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+            auto *out = block.getChannelPointer(ch);
+            const auto *next = nextBlock.getChannelPointer(ch);
+            for (size_t i = warmup; i < numSamples; ++i) {
+                const auto position = fadePosition + i - warmup;
+                const auto gain = position < fadeLength ? static_cast<FloatType>(position) * step
+                                                        : static_cast<FloatType>(1);
+                out[i] += (next[i] - out[i]) * gain;
+            }
+        }
+        warmupRemaining -= warmup;
+        fadePosition += numSamples - warmup;
+        if (fadePosition >= fadeLength) {
+            paths[activePath].sampler = nullptr;
+            activePath = 1 - activePath;
+            switching = false;
+            samplersInUse.store(getSamplerBit(paths[activePath].slot));
+        }
+    }
+
+    /**
+     * pick up the latest snapshot, called on the audio thread at the top of each block
+     * and from prepare(), while the audio thread is stopped
+     */
+    void loadParameters(bool force) {
+        if (!parameterSlot.update() && !force) {
+            return;
+        }
+        current = parameterSlot.getReadBuffer();
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            const auto targets = getShapeTargets(current, i);
+            shapes[i].wet.setTargetValue(targets[0]);
+            shapes[i].curve1.setTargetValue(targets[1]);
+            shapes[i].curve2.setTargetValue(targets[2]);
+        }
+        weightSmoother.setTargetValue(current.weight);
+        lowSmoother.setTargetValue(current.lowSplit);
+        highSmoother.setTargetValue(current.highSplit);
+        if (force) {
+            for (auto &shape: shapes) {
+                for (auto *s: {&shape.wet, &shape.curve1, &shape.curve2}) {
+                    s->setCurrentAndTargetValue(s->getTargetValue());
                 }
             }
-            overSamplers[idxSampler]->processSamplesDown(context.getOutputBlock());
+            weightSmoother.setCurrentAndTargetValue(weightSmoother.getTargetValue());
+            for (auto *s: {&lowSmoother, &highSmoother}) {
+                s->setCurrentAndTargetValue(s->getTargetValue());
+            }
+        }
+        // styles and compensation switch at once, only the continuous parameters ramp
+        for (auto &shape: shapes) {
+            shape.mixer.setShapes(shape.curve1.getCurrentValue(), shape.curve2.getCurrentValue(),
+                                  weightSmoother.getCurrentValue(), current.compensation);
+            shape.mixer.setTypes(current.type1, current.type2);
+        }
+        if (force) {
+            auto &path = paths[activePath];
+            const auto slot = getRequestedSlot(current);
+            path.sampler = samplerSlots[slot].load();
+            samplersInUse.store(getSamplerBit(slot));
+            if (path.sampler != nullptr) {
+                attachSampler(path, slot);
+            }
         }
     }
 
-    void prepare(const juce::dsp::ProcessSpec &spec) {
-        reset();
-        sampleRate = spec.sampleRate;
-        for (size_t i = 0; i < numBands - 1; ++i) {
-            filters[i].prepare(spec);
+    static uint32_t getSamplerBit(size_t slot) { return static_cast<uint32_t>(1) << slot; }
+
+    /** every quality shares the oversampler of 1x, which has no filters */
+    static size_t getSlot(size_t idx, size_t quality) {
+        return idx == 0 ? 0 : quality * numSamplers + idx;
+    }
+
+    /** the oversampler to run, while rendering offline it is the render factor with the FIR filters */
+    static size_t getRequestedSlot(const WaveShaperParameters<FloatType> &p) {
+        if (p.nonRealtime && p.idxRender > 0) {
+            return getSlot(juce::jmax(p.idxSampler, p.idxRender), zldsp::overSampleQuality::fir);
+        }
+        return getSlot(p.idxSampler, p.idxQuality);
+    }
+
+    /** the latency reported to the host, the active oversampler is delayed up to it */
+    size_t getTargetLatency(const WaveShaperParameters<FloatType> &p) const {
+        if (p.constantLatency) {
+            return maxLatency;
         }
-        bufferSeparation.setSize((int) spec.numChannels * numBands,
-                                 int(16 * spec.maximumBlockSize), false, false,
-                                 true);
-        for (size_t i = 0; i < numSamplers; ++i) {
-            overSamplers[i] = std::make_unique<juce::dsp::Oversampling<FloatType >>(
-                    spec.numChannels, i,
-                    juce::dsp::Oversampling<FloatType>::filterHalfBandFIREquiripple, true,
-                    true);
-            overSamplers[i]->initProcessing(spec.maximumBlockSize);
+        const auto latency = slotLatencies[getSlot(p.idxSampler, p.idxQuality)];
+        if (p.idxRender > 0) {
+            const auto renderSlot = getSlot(juce::jmax(p.idxSampler, p.idxRender), zldsp::overSampleQuality::fir);
+            return juce::jmax(latency, slotLatencies[renderSlot]);
         }
+        return latency;
     }
 
-private:
-    juce::AudioProcessor *processorRef;
-    constexpr static const int numSamplers = 5, numBands = 3;
-    std::atomic<double> sampleRate;
-    WaveHelper<FloatType> helper;
-    std::array<std::unique_ptr<juce::dsp::Oversampling<FloatType>>, numSamplers>
-            overSamplers{};
-    std::atomic<size_t> idxSampler = zldsp::overSample::defaultI;
-    std::atomic<bool> split = zldsp::bandSplit::defaultV, effect = zldsp::effectIn::defaultV;
-    std::array<LRFilters<FloatType>, numBands - 1> filters{};
-    juce::AudioBuffer<FloatType> bufferSeparation;
-};
+    size_t getDelaySamples(const SamplerPath &path) const {
+        const auto target = getTargetLatency(current);
+        return target > slotLatencies[path.slot] ? target - slotLatencies[path.slot] : 0;
+    }
 
-template<typename FloatType>
-class WaveShaperAttach : public juce::AudioProcessorValueTreeState::Listener {
-public:
-    explicit WaveShaperAttach(WaveShaper<FloatType> &shaper, juce::AudioProcessorValueTreeState &parameters) {
-        waveShaper = &shaper;
-        apvts = &parameters;
-    }
-
-    void addListeners() {
-        std::array IDs{zldsp::effectIn::ID, zldsp::style1::ID, zldsp::style2::ID,
-                       zldsp::wet::ID, zldsp::curve1::ID, zldsp::curve2::ID, zldsp::weight::ID,
-                       zldsp::bandSplit::ID, zldsp::lowSplit::ID, zldsp::highSplit::ID,
-                       zldsp::overSample::ID, zldsp::autoGain::ID};
-        for (auto &ID: IDs) {
-            apvts->addParameterListener(ID, this);
-        }
-    }
-
-    void parameterChanged(const juce::String &parameterID, float newValue) override {
-        if (parameterID == zldsp::wet::ID) {
-            waveShaper->setWet(static_cast<FloatType>(newValue) / static_cast<FloatType>(100));
-        } else if (parameterID == zldsp::curve1::ID || parameterID == zldsp::curve2::ID ||
-                   parameterID == zldsp::weight::ID || parameterID == zldsp::autoGain::ID) {
-            auto curve1 = apvts->getRawParameterValue(zldsp::curve1::ID)->load();
-            auto curve2 = apvts->getRawParameterValue(zldsp::curve2::ID)->load();
-            auto weight = apvts->getRawParameterValue(zldsp::weight::ID)->load();
-            auto compensation = static_cast<bool>(apvts->getRawParameterValue(zldsp::autoGain::ID)->load());
-            if (parameterID == zldsp::curve1::ID) {
-                curve1 = newValue;
-            } else if (parameterID == zldsp::curve2::ID) {
-                curve2 = newValue;
-            } else if (parameterID == zldsp::weight::ID) {
-                weight = newValue;
-            } else {
-                compensation = static_cast<bool>(newValue);
+    /** set up the rate dependent state of path for the oversampler it now holds */
+    void attachSampler(SamplerPath &path, size_t slot) {
+        path.slot = slot;
+        path.idx = slot % numSamplers;
+        path.crossover.setSampleRate(sampleRate * static_cast<double>(static_cast<size_t>(1) << path.idx));
+        path.crossover.setCutoffFrequencies(static_cast<FloatType>(lowSmoother.getCurrentValue()),
+                                            static_cast<FloatType>(highSmoother.getCurrentValue()));
+        updateDelay(path);
+    }
+
+    void updateDelay(SamplerPath &path) {
+        path.delaySamples = getDelaySamples(path);
+        path.delay.reset();
+        path.delay.setDelay(static_cast<FloatType>(path.delaySamples));
+    }
+
+    /**
+     * move to the requested oversampler once the message thread has built it, called on the audio thread
+     * samplersInUse is raised before the slot is read, so the message thread never frees a sampler in use
+     */
+    void switchSampler() {
+        if (switching) {
+            // the request is picked up again once the running switch is complete
+            return;
+        }
+        auto &active = paths[activePath];
+        const auto requested = getRequestedSlot(current);
+        if (requested == active.slot && active.sampler != nullptr) {
+            if (active.delaySamples != getDelaySamples(active)) {
+                updateDelay(active);
             }
-            waveShaper->setShapes(static_cast<FloatType>(zldsp::curve1::formatV(curve1)),
-                                  static_cast<FloatType>(zldsp::curve2::formatV(curve2)),
-                                  static_cast<FloatType>(zldsp::weight::formatV(weight)),
-                                  compensation);
-        } else if (parameterID == zldsp::lowSplit::ID || parameterID == zldsp::highSplit::ID) {
-            auto lowSplit = apvts->getRawParameterValue(zldsp::lowSplit::ID)->load();
-            auto highSplit = apvts->getRawParameterValue(zldsp::highSplit::ID)->load();
-            if (parameterID == zldsp::lowSplit::ID) {
-                lowSplit = newValue;
-            } else {
-                highSplit = newValue;
+            return;
+        }
+        samplersInUse.store(getSamplerBit(active.slot) | getSamplerBit(requested));
+        auto *next = samplerSlots[requested].load();
+        if (next == nullptr) {
+            samplersInUse.store(getSamplerBit(active.slot));
+            return;
+        }
+        next->reset();
+        if (active.sampler == nullptr || !current.constantLatency) {
+            // the latency changes anyway, so there is nothing to fade across
+            active.sampler = next;
+            attachSampler(active, requested);
+            samplersInUse.store(getSamplerBit(requested));
+            return;
+        }
+        auto &incoming = paths[1 - activePath];
+        incoming.sampler = next;
+        attachSampler(incoming, requested);
+        // long enough for the filters and the compensation delay to fill
+        warmupRemaining = 2 * maxLatency;
+        fadePosition = 0;
+        fadeLength = juce::jmax(static_cast<size_t>(1), static_cast<size_t>(crossfadeSeconds * sampleRate));
+        switching = true;
+    }
+
+    /**
+     * the IIR polyphase filters have the lowest latency, the equiripple FIR is linear phase,
+     * and the eco FIR is linear phase with shorter filters
+     */
+    static std::unique_ptr<juce::dsp::Oversampling<FloatType>> createSampler(size_t numChannels, size_t slot,
+                                                                             size_t maximumBlockSize) {
+        using Filter = typename juce::dsp::Oversampling<FloatType>::FilterType;
+        const auto quality = slot / numSamplers;
+        const auto filter = quality == zldsp::overSampleQuality::iir
+                            ? Filter::filterHalfBandPolyphaseIIR : Filter::filterHalfBandFIREquiripple;
+        auto sampler = std::make_unique<juce::dsp::Oversampling<FloatType>>(
+                numChannels, slot % numSamplers, filter, quality != zldsp::overSampleQuality::eco, true);
+        // integer latencies, so that the compensation delays line the factors up exactly
+        sampler->setUsingIntegerLatency(true);
+        sampler->initProcessing(maximumBlockSize);
+        return sampler;
+    }
+
+    /** build and publish the requested oversampler and report the latency, called on the message thread */
+    void updateSamplers() {
+        const juce::ScopedLock lock(samplerLock);
+        if (samplerSpec.numChannels == 0) {
+            return;
+        }
+        const auto p = state->getParameters<FloatType>();
+        if (linkOnly && !p.link) {
+            // withdraw every oversampler, the shapers that run report the latency
+            requestedSlot = numSlots;
+        } else {
+            requestedSlot = getRequestedSlot(p);
+            auto &requested = overSamplers[requestedSlot];
+            if (requested == nullptr) {
+                requested = createSampler(samplerSpec.numChannels, requestedSlot, samplerSpec.maximumBlockSize);
+            }
+            samplerSlots[requestedSlot].store(requested.get());
+            samplerLatency.store(static_cast<int>(slotLatencies[requestedSlot]));
+            processorRef->setLatencySamples(static_cast<int>(getTargetLatency(p)));
+        }
+        // off the message thread (offline renders), the next update or getMemoryUsage() frees them
+        if (!retireSamplers() && juce::MessageManager::existsAndIsCurrentThread()) {
+            startTimer(retireInterval);
+        }
+    }
+
+    /**
+     * withdraw every oversampler but the requested one, and free those the audio thread has let go
+     * returns false while some are still in use
+     */
+    bool retireSamplers() {
+        bool retired = true;
+        for (size_t slot = 0; slot < numSlots; ++slot) {
+            if (slot == requestedSlot || overSamplers[slot] == nullptr) {
+                continue;
             }
-            waveShaper->setCutoffFrequency(lowSplit, highSplit);
-        } else if (parameterID == zldsp::bandSplit::ID) {
-            waveShaper->setSplitFlag(static_cast<bool>(newValue));
-        } else if (parameterID == zldsp::effectIn::ID) {
-            waveShaper->setEffectFlag(static_cast<bool>(newValue));
-        } else if (parameterID == zldsp::style1::ID || parameterID == zldsp::style2::ID) {
-            auto type1 = apvts->getRawParameterValue(zldsp::style1::ID)->load();
-            auto type2 = apvts->getRawParameterValue(zldsp::style2::ID)->load();
-            if (parameterID == zldsp::style1::ID) {
-                type1 = newValue;
+            samplerSlots[slot].store(nullptr);
+            if ((samplersInUse.load() & getSamplerBit(slot)) == 0) {
+                overSamplers[slot].reset();
             } else {
-                type2 = newValue;
+                retired = false;
             }
-            waveShaper->setTypes(static_cast<size_t>(type1), static_cast<size_t>(type2));
-        } else if (parameterID == zldsp::overSample::ID) {
-            waveShaper->setOverSampleFactor(static_cast<int>(newValue));
         }
+        return retired;
     }
 
-private:
-    WaveShaper<FloatType> *waveShaper;
-    juce::AudioProcessorValueTreeState *apvts;
+    void timerCallback() override {
+        const juce::ScopedLock lock(samplerLock);
+        if (retireSamplers()) {
+            stopTimer();
+        }
+    }
 };
 
 #endif
\ No newline at end of file
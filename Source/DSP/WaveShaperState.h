@@ -0,0 +1,286 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+#ifndef ZLINFLATOR_WAVESHAPERSTATE_H
+#define ZLINFLATOR_WAVESHAPERSTATE_H
+
+#include "juce_audio_processors/juce_audio_processors.h"
+#include "dsp_defines.h"
+
+/**
+ * everything the audio thread needs from the parameters, in the units the shaper works in
+ */
+template<typename FloatType>
+struct WaveShaperParameters {
+    FloatType wet = static_cast<FloatType>(zldsp::wet::formatV(zldsp::wet::defaultV));
+    FloatType curve1 = static_cast<FloatType>(zldsp::curve1::formatV(zldsp::curve1::defaultV));
+    FloatType curve2 = static_cast<FloatType>(zldsp::curve2::formatV(zldsp::curve2::defaultV));
+    FloatType weight = static_cast<FloatType>(zldsp::weight::formatV(zldsp::weight::defaultV));
+    // the side channel in mid/side mode, the mid channel takes wet and the curves above
+    FloatType sideWet = static_cast<FloatType>(zldsp::sideWet::formatV(zldsp::sideWet::defaultV));
+    FloatType sideCurve1 = static_cast<FloatType>(zldsp::sideCurve1::formatV(zldsp::sideCurve1::defaultV));
+    FloatType sideCurve2 = static_cast<FloatType>(zldsp::sideCurve2::formatV(zldsp::sideCurve2::defaultV));
+    bool midSide = zldsp::midSide::defaultV;
+    bool compensation = zldsp::autoGain::defaultV;
+    size_t type1 = zldsp::style1::defaultI, type2 = zldsp::style2::defaultI;
+    float lowSplit = zldsp::lowSplit::defaultV, highSplit = zldsp::highSplit::defaultV;
+    size_t idxSampler = zldsp::overSample::defaultI, idxQuality = zldsp::overSampleQuality::defaultI;
+    size_t idxRender = zldsp::renderOverSample::defaultI;
+    bool constantLatency = zldsp::constantLatency::defaultV, nonRealtime = false;
+    bool split = zldsp::bandSplit::defaultV, effect = zldsp::effectIn::defaultV, table = zldsp::lookupTable::defaultV;
+    bool link = zldsp::channelLink::defaultV;
+};
+
+/**
+ * the parameters shared by every WaveShaper of a processor
+ * the setters only store atomics and raise a flag, so they are safe to call from any thread, the audio thread included
+ * update() merges the changes into one snapshot and hands it to the listeners, together with the work a change
+ * brings, the lookup tables and the oversamplers; the shapers publish the snapshot to their audio thread whole,
+ * so a block never mixes old and new fields
+ * update() runs on the message thread timer, never from a setter; only while non-realtime (offline renders)
+ * or without any message thread does the setter merge at once on the calling thread
+ */
+class WaveShaperState : private juce::Timer {
+public:
+    /** the parameters the shapers follow, in the order of IDs */
+    enum Field : size_t {
+        effectIn, style1, style2, wet, curve1, curve2, weight, autoGain,
+        sideWet, sideCurve1, sideCurve2, midSide, bandSplit, channelLink, lowSplit, highSplit,
+        overSample, overSampleQuality, renderOverSample, constantLatency, lookupTable,
+        fieldNUM
+    };
+
+    static constexpr std::array<const char *, fieldNUM> IDs{
+            zldsp::effectIn::ID, zldsp::style1::ID, zldsp::style2::ID,
+            zldsp::wet::ID, zldsp::curve1::ID, zldsp::curve2::ID, zldsp::weight::ID, zldsp::autoGain::ID,
+            zldsp::sideWet::ID, zldsp::sideCurve1::ID, zldsp::sideCurve2::ID, zldsp::midSide::ID,
+            zldsp::bandSplit::ID, zldsp::channelLink::ID, zldsp::lowSplit::ID, zldsp::highSplit::ID,
+            zldsp::overSample::ID, zldsp::overSampleQuality::ID, zldsp::renderOverSample::ID,
+            zldsp::constantLatency::ID, zldsp::lookupTable::ID};
+
+    /** the message thread side of the shapers, called under the update lock */
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+
+        /** the curves, the styles or the table mode have changed */
+        virtual void tablesChanged() = 0;
+
+        /** the oversampling factor, its quality, the latency mode, the channel link or the realtime mode have changed */
+        virtual void samplersChanged() = 0;
+
+        /** a new snapshot is ready for the audio thread, called after the tables and the oversamplers */
+        virtual void parametersChanged() = 0;
+    };
+
+    WaveShaperState() {
+        const std::array<float, fieldNUM> defaults{
+                zldsp::effectIn::defaultV, zldsp::style1::defaultI, zldsp::style2::defaultI,
+                zldsp::wet::defaultV, zldsp::curve1::defaultV, zldsp::curve2::defaultV, zldsp::weight::defaultV,
+                zldsp::autoGain::defaultV,
+                zldsp::sideWet::defaultV, zldsp::sideCurve1::defaultV, zldsp::sideCurve2::defaultV,
+                zldsp::midSide::defaultV, zldsp::bandSplit::defaultV, zldsp::channelLink::defaultV,
+                zldsp::lowSplit::defaultV, zldsp::highSplit::defaultV,
+                zldsp::overSample::defaultI, zldsp::overSampleQuality::defaultI, zldsp::renderOverSample::defaultI,
+                zldsp::constantLatency::defaultV, zldsp::lookupTable::defaultV};
+        for (size_t i = 0; i < fieldNUM; ++i) {
+            values[i].store(defaults[i], std::memory_order_relaxed);
+        }
+        merged = defaults;
+        hasMessageThread = juce::MessageManager::getInstanceWithoutCreating() != nullptr;
+        if (juce::MessageManager::existsAndIsCurrentThread()) {
+            startTimer(updateInterval);
+        }
+    }
+
+    ~WaveShaperState() override {
+        stopTimer();
+    }
+
+    /** set a parameter in the units of the parameter, lock-free */
+    void setValue(size_t field, float value) {
+        values[field].store(value, std::memory_order_relaxed);
+        changed(isShapeField(field), isSamplerField(field));
+    }
+
+    /** while rendering offline, the shapers run the render oversampler, lock-free */
+    void setNonRealtime(bool nonRealtimeFlag) {
+        nonRealtime.store(nonRealtimeFlag, std::memory_order_relaxed);
+        changed(false, true);
+    }
+
+    /**
+     * start merging the changes on the message thread, for a state made off the message thread
+     * call it from prepareToPlay or the editor, never from the audio thread
+     */
+    void startUpdates() {
+        if (hasMessageThread && !isTimerRunning()) {
+            startTimer(updateInterval);
+        }
+    }
+
+    /** the merged parameters, never on the audio thread */
+    template<typename FloatType>
+    WaveShaperParameters<FloatType> getParameters() const {
+        const juce::ScopedLock lock(updateLock);
+        WaveShaperParameters<FloatType> p;
+        p.effect = getBool(effectIn);
+        p.type1 = static_cast<size_t>(getValue(style1));
+        p.type2 = static_cast<size_t>(getValue(style2));
+        p.wet = static_cast<FloatType>(zldsp::wet::formatV(getValue(wet)));
+        p.curve1 = static_cast<FloatType>(zldsp::curve1::formatV(getValue(curve1)));
+        p.curve2 = static_cast<FloatType>(zldsp::curve2::formatV(getValue(curve2)));
+        p.weight = static_cast<FloatType>(zldsp::weight::formatV(getValue(weight)));
+        p.compensation = getBool(autoGain);
+        p.sideWet = static_cast<FloatType>(zldsp::sideWet::formatV(getValue(sideWet)));
+        p.sideCurve1 = static_cast<FloatType>(zldsp::sideCurve1::formatV(getValue(sideCurve1)));
+        p.sideCurve2 = static_cast<FloatType>(zldsp::sideCurve2::formatV(getValue(sideCurve2)));
+        p.midSide = getBool(midSide);
+        p.split = getBool(bandSplit);
+        p.link = getBool(channelLink);
+        p.lowSplit = getValue(lowSplit);
+        p.highSplit = getValue(highSplit);
+        p.idxSampler = static_cast<size_t>(getValue(overSample));
+        p.idxQuality = static_cast<size_t>(getValue(overSampleQuality));
+        p.idxRender = static_cast<size_t>(getValue(renderOverSample));
+        p.constantLatency = getBool(constantLatency);
+        p.table = getBool(lookupTable);
+        p.nonRealtime = mergedNonRealtime;
+        return p;
+    }
+
+    /** message thread, the listener gets the current snapshot at once */
+    void addListener(Listener *listener) {
+        const juce::ScopedLock lock(updateLock);
+        listeners.addIfNotAlreadyThere(listener);
+        listener->parametersChanged();
+    }
+
+    /** message thread */
+    void removeListener(Listener *listener) {
+        const juce::ScopedLock lock(updateLock);
+        listeners.removeFirstMatchingValue(listener);
+    }
+
+    /** merge the pending changes and hand them to the listeners, never on the audio thread */
+    void update() {
+        const juce::ScopedLock lock(updateLock);
+        const auto params = parametersDirty.exchange(false, std::memory_order_acquire);
+        const auto tables = tablesDirty.exchange(false, std::memory_order_acquire);
+        const auto samplers = samplersDirty.exchange(false, std::memory_order_acquire);
+        if (!params && !tables && !samplers) {
+            return;
+        }
+        for (size_t i = 0; i < fieldNUM; ++i) {
+            merged[i] = values[i].load(std::memory_order_relaxed);
+        }
+        mergedNonRealtime = nonRealtime.load(std::memory_order_relaxed);
+        for (auto *listener: listeners) {
+            if (tables) {
+                listener->tablesChanged();
+            }
+            if (samplers) {
+                listener->samplersChanged();
+            }
+            listener->parametersChanged();
+        }
+    }
+
+private:
+    // how often (in ms) the message thread picks up the changes made on other threads
+    constexpr static const int updateInterval = 20;
+    std::array<std::atomic<float>, fieldNUM> values;
+    std::atomic<bool> nonRealtime{false};
+    std::atomic<bool> parametersDirty{false}, tablesDirty{false}, samplersDirty{false};
+    bool hasMessageThread{false};
+    // message side: the merged values and the shapers, guarded by updateLock, which the audio thread never takes
+    juce::CriticalSection updateLock;
+    std::array<float, fieldNUM> merged{};
+    bool mergedNonRealtime{false};
+    juce::Array<Listener *> listeners;
+
+    float getValue(size_t field) const {
+        return merged[field];
+    }
+
+    bool getBool(size_t field) const {
+        return getValue(field) > .5f;
+    }
+
+    static bool isShapeField(size_t field) {
+        return field == style1 || field == style2 || field == curve1 || field == curve2 || field == weight ||
+               field == autoGain || field == sideCurve1 || field == sideCurve2 || field == lookupTable;
+    }
+
+    static bool isSamplerField(size_t field) {
+        return field == overSample || field == overSampleQuality || field == renderOverSample ||
+               field == constantLatency || field == channelLink;
+    }
+
+    void changed(bool shapeChanged, bool samplerChanged) {
+        if (shapeChanged) {
+            tablesDirty.store(true, std::memory_order_release);
+        }
+        if (samplerChanged) {
+            samplersDirty.store(true, std::memory_order_release);
+        }
+        parametersDirty.store(true, std::memory_order_release);
+        if (nonRealtime.load(std::memory_order_relaxed) || !hasMessageThread) {
+            update();
+        }
+    }
+
+    void timerCallback() override {
+        update();
+    }
+};
+
+/**
+ * forward the parameters of an AudioProcessorValueTreeState to a WaveShaperState
+ * parameterChanged may run on the audio thread, it only stores the new value
+ */
+class WaveShaperAttach : public juce::AudioProcessorValueTreeState::Listener {
+public:
+    explicit WaveShaperAttach(WaveShaperState &parameterState, juce::AudioProcessorValueTreeState &parameters) {
+        state = &parameterState;
+        apvts = &parameters;
+    }
+
+    ~WaveShaperAttach() override {
+        for (auto &ID: WaveShaperState::IDs) {
+            apvts->removeParameterListener(ID, this);
+        }
+    }
+
+    /** start listening, and take over the current values */
+    void addListeners() {
+        for (size_t i = 0; i < WaveShaperState::fieldNUM; ++i) {
+            apvts->addParameterListener(WaveShaperState::IDs[i], this);
+            state->setValue(i, apvts->getRawParameterValue(WaveShaperState::IDs[i])->load());
+        }
+    }
+
+    void parameterChanged(const juce::String &parameterID, float newValue) override {
+        for (size_t i = 0; i < WaveShaperState::fieldNUM; ++i) {
+            if (parameterID == WaveShaperState::IDs[i]) {
+                state->setValue(i, newValue);
+                return;
+            }
+        }
+    }
+
+private:
+    WaveShaperState *state;
+    juce::AudioProcessorValueTreeState *apvts;
+};
+
+#endif //ZLINFLATOR_WAVESHAPERSTATE_H
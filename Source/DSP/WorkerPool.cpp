@@ -0,0 +1,194 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#include "WorkerPool.h"
+#include "RealtimeAudit.h"
+
+#include <cerrno>
+
+#if JUCE_MAC || JUCE_IOS
+#include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <semaphore.h>
+#endif
+
+#if JUCE_INTEL
+#include <immintrin.h>
+#endif
+
+namespace zldsp {
+    /** a counting semaphore whose post neither allocates nor locks */
+    class WorkerPool::Semaphore {
+    public:
+#if JUCE_MAC || JUCE_IOS
+        Semaphore() : handle(dispatch_semaphore_create(0)) {}
+
+        ~Semaphore() { dispatch_release(handle); }
+
+        void post() { dispatch_semaphore_signal(handle); }
+
+        void wait() { dispatch_semaphore_wait(handle, DISPATCH_TIME_FOREVER); }
+
+    private:
+        dispatch_semaphore_t handle;
+#elif JUCE_WINDOWS
+        Semaphore() : handle(CreateSemaphoreW(nullptr, 0, LONG_MAX, nullptr)) {}
+
+        ~Semaphore() { CloseHandle(handle); }
+
+        void post() { ReleaseSemaphore(handle, 1, nullptr); }
+
+        void wait() { WaitForSingleObject(handle, INFINITE); }
+
+    private:
+        HANDLE handle;
+#else
+        Semaphore() { sem_init(&handle, 0, 0); }
+
+        ~Semaphore() { sem_destroy(&handle); }
+
+        void post() { sem_post(&handle); }
+
+        void wait() {
+            while (sem_wait(&handle) != 0 && errno == EINTR) {}
+        }
+
+    private:
+        sem_t handle{};
+#endif
+    };
+
+    class WorkerPool::Worker : public juce::Thread {
+    public:
+        explicit Worker(WorkerPool &workerPool) : juce::Thread("ZLInflator Worker"), pool(workerPool) {}
+
+        void run() override {
+            // the workgroup does not change while the worker runs, setWorkgroup restarts the workers
+            juce::WorkgroupToken token;
+            if (pool.workgroup) {
+                pool.workgroup.join(token);
+            }
+            while (true) {
+                pool.semaphore->wait();
+                if (threadShouldExit()) {
+                    return;
+                }
+                ZL_REALTIME_AUDIT_SECTION;
+                pool.work();
+            }
+        }
+
+    private:
+        WorkerPool &pool;
+    };
+
+    namespace {
+        inline void pause() {
+#if JUCE_INTEL
+            _mm_pause();
+#elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+            __asm__ __volatile__("yield");
+#endif
+        }
+    }
+
+    WorkerPool::WorkerPool() : semaphore(std::make_unique<Semaphore>()) {}
+
+    WorkerPool::~WorkerPool() {
+        stopWorkers();
+    }
+
+    void WorkerPool::setNumWorkers(size_t numWorkers, int samplesPerBlock, double sampleRate) {
+        if (numWorkers == workers.size() && samplesPerBlock == blockSize && juce::exactlyEqual(sampleRate, rate)) {
+            return;
+        }
+        blockSize = samplesPerBlock;
+        rate = sampleRate;
+        stopWorkers();
+        startWorkers(numWorkers);
+    }
+
+    void WorkerPool::setWorkgroup(const juce::AudioWorkgroup &newWorkgroup) {
+        if (newWorkgroup == workgroup) {
+            return;
+        }
+        const auto numWorkers = workers.size();
+        stopWorkers();
+        workgroup = newWorkgroup;
+        startWorkers(numWorkers);
+    }
+
+    void WorkerPool::startWorkers(size_t numWorkers) {
+        const auto options = juce::Thread::RealtimeOptions{}
+                .withApproximateAudioProcessingTime(juce::jmax(1, blockSize), rate > 0.0 ? rate : 48000.0);
+        for (size_t i = 0; i < numWorkers; ++i) {
+            workers.push_back(std::make_unique<Worker>(*this));
+            // without the permission for realtime scheduling, fall back to the highest normal priority
+            if (!workers.back()->startRealtimeThread(options)) {
+                workers.back()->startThread(juce::Thread::Priority::highest);
+            }
+        }
+    }
+
+    void WorkerPool::stopWorkers() {
+        for (auto &worker: workers) {
+            worker->signalThreadShouldExit();
+        }
+        for (size_t i = 0; i < workers.size(); ++i) {
+            semaphore->post();
+        }
+        for (auto &worker: workers) {
+            worker->stopThread(-1);
+        }
+        // posts left over from late workers only wake the next workers for nothing, they find no job to claim
+        workers.clear();
+    }
+
+    void WorkerPool::runJobs(size_t jobCount, JobFunction function, void *context) {
+        jassert(jobCount <= maxJobs);
+        jobFunction = function;
+        jobContext = context;
+        doneJobs.store(0, std::memory_order_relaxed);
+        // a new run number, so that a worker holding the claim word of the last run cannot claim from this one
+        ++currentRun;
+        claims.store((static_cast<juce::uint64>(currentRun) << runShift) |
+                     (static_cast<juce::uint64>(jobCount) << countShift), std::memory_order_release);
+        // the caller takes a job as well, so one worker fewer than jobs is enough
+        const auto numWoken = juce::jmin(workers.size(), jobCount > 0 ? jobCount - 1 : 0);
+        for (size_t i = 0; i < numWoken; ++i) {
+            semaphore->post();
+        }
+        work();
+        // only the jobs a worker has claimed can be left, a worker that has not woken up yet is not waited for
+        while (doneJobs.load(std::memory_order_acquire) != jobCount) {
+            pause();
+        }
+    }
+
+    void WorkerPool::work() {
+        auto word = claims.load(std::memory_order_acquire);
+        while ((word & maxJobs) < ((word >> countShift) & maxJobs)) {
+            // the claim fails if another thread took the job or a new run has started, word is reloaded then
+            if (claims.compare_exchange_weak(word, word + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                jobFunction(jobContext, static_cast<size_t>(word & maxJobs));
+                doneJobs.fetch_add(1, std::memory_order_release);
+                word = claims.load(std::memory_order_acquire);
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#ifndef ZLINFLATOR_WORKERPOOL_H
+#define ZLINFLATOR_WORKERPOOL_H
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace zldsp {
+    /**
+     * a few worker threads that help the audio thread through a batch of independent jobs
+     * the jobs are claimed from an atomic word that holds the run, the number of jobs and the next job,
+     * the calling thread claims jobs as well and afterwards only waits for the jobs that have been claimed,
+     * so a worker that wakes late never holds up the caller, it finds nothing left and goes back to sleep
+     * the workers are woken with a semaphore post, so the calling thread never waits on a lock
+     */
+    class WorkerPool {
+    public:
+        WorkerPool();
+
+        ~WorkerPool();
+
+        /**
+         * start or stop worker threads, not realtime safe
+         * the workers are realtime threads, scheduled for blocks of samplesPerBlock samples at sampleRate
+         */
+        void setNumWorkers(size_t numWorkers, int samplesPerBlock, double sampleRate);
+
+        /** the workers join the audio workgroup of the host, running workers are restarted, not realtime safe */
+        void setWorkgroup(const juce::AudioWorkgroup &newWorkgroup);
+
+        size_t getNumWorkers() const { return workers.size(); }
+
+        /**
+         * call job(index) for every index in [0, numJobs), and return once all of them are finished
+         * it neither allocates nor locks, numJobs must not exceed maxJobs
+         */
+        template<typename Job>
+        void run(size_t numJobs, Job &job) {
+            runJobs(numJobs, [](void *context, size_t index) { (*static_cast<Job *>(context))(index); }, &job);
+        }
+
+        static constexpr size_t maxJobs = 0xffff;
+
+    private:
+        class Semaphore;
+
+        class Worker;
+
+        using JobFunction = void (*)(void *, size_t);
+
+        // the claim word: the run in the upper 32 bits, then the number of jobs and the next job in 16 bits each
+        static constexpr int countShift = 16, runShift = 32;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::unique_ptr<Semaphore> semaphore;
+        juce::AudioWorkgroup workgroup;
+        int blockSize = 0;
+        double rate = 0.0;
+        // written by the caller before a run is published in claims, stable until all of its jobs are done
+        JobFunction jobFunction = nullptr;
+        void *jobContext = nullptr;
+        juce::uint32 currentRun = 0;
+        std::atomic<juce::uint64> claims{0};
+        // finished jobs of the current run
+        std::atomic<size_t> doneJobs{0};
+
+        void runJobs(size_t jobCount, JobFunction function, void *context);
+
+        /** claim and run jobs of the current run until none are left */
+        void work();
+
+        void startWorkers(size_t numWorkers);
+
+        void stopWorkers();
+
+        JUCE_DECLARE_NON_COPYABLE(WorkerPool)
+    };
+}
+
+#endif //ZLINFLATOR_WORKERPOOL_H
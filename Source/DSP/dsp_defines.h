@@ -81,6 +81,40 @@ namespace zldsp {
         }
     };
 
+    // the side channel in mid/side mode
+    class sideWet : public FloatParameters<sideWet> {
+    public:
+        auto static constexpr ID = "side_wet";
+        auto static constexpr name = "Side Wet (%)";
+        inline auto static const range = juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f);
+        auto static constexpr defaultV = 100.0f;
+        static float formatV(float v) {
+            return v / 100.f;
+        }
+    };
+
+    class sideCurve1 : public FloatParameters<sideCurve1> {
+    public:
+        auto static constexpr ID = "side_curve1";
+        auto static constexpr name = "Side Curve (%)";
+        inline auto static const range = juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f);
+        auto static constexpr defaultV = 25.0f;
+        static float formatV(float v) {
+            return v / 100.f;
+        }
+    };
+
+    class sideCurve2 : public FloatParameters<sideCurve2> {
+    public:
+        auto static constexpr ID = "side_curve2";
+        auto static constexpr name = "Side Curve (%)";
+        inline auto static const range = juce::NormalisableRange<float>(0.0f, 100.0f, 0.1f);
+        auto static constexpr defaultV = 25.0f;
+        static float formatV(float v) {
+            return v / 100.f;
+        }
+    };
+
     class weight : public FloatParameters<weight> {
     public:
         auto static constexpr ID = "weight";
@@ -139,6 +173,20 @@ namespace zldsp {
         auto static constexpr defaultV = false;
     };
 
+    class channelLink : public BoolParameters<channelLink> {
+    public:
+        auto static constexpr ID = "channel_link";
+        auto static constexpr name = "Channel Link";
+        auto static constexpr defaultV = false;
+    };
+
+    class midSide : public BoolParameters<midSide> {
+    public:
+        auto static constexpr ID = "mid_side";
+        auto static constexpr name = "Mid/Side";
+        auto static constexpr defaultV = false;
+    };
+
     class autoGain : public BoolParameters<autoGain> {
     public:
         auto static constexpr ID = "auto_gain";
@@ -146,6 +194,20 @@ namespace zldsp {
         auto static constexpr defaultV = false;
     };
 
+    class constantLatency : public BoolParameters<constantLatency> {
+    public:
+        auto static constexpr ID = "constant_latency";
+        auto static constexpr name = "Constant Latency";
+        auto static constexpr defaultV = false;
+    };
+
+    class lookupTable : public BoolParameters<lookupTable> {
+    public:
+        auto static constexpr ID = "lookup_table";
+        auto static constexpr name = "Lookup Table";
+        auto static constexpr defaultV = false;
+    };
+
     // choices
     template<class T>
     class ChoiceParameters {
@@ -171,6 +233,28 @@ namespace zldsp {
         int static constexpr defaultI = 0;
     };
 
+    class renderOverSample : public ChoiceParameters<renderOverSample> {
+    public:
+        auto static constexpr ID = "render_over_sample";
+        auto static constexpr name = "Render Over Sampling";
+        inline auto static const choices = juce::StringArray{"Live", "2x", "4x", "8x", "16x"};
+        int static constexpr defaultI = 0;
+    };
+
+    class overSampleQuality : public ChoiceParameters<overSampleQuality> {
+    public:
+        auto static constexpr ID = "over_sample_quality";
+        auto static constexpr name = "Filter Quality";
+        inline auto static const choices = juce::StringArray{"IIR", "FIR", "Eco FIR"};
+        enum {
+            iir,
+            fir,
+            eco,
+            qualityNUM
+        };
+        int static constexpr defaultI = fir;
+    };
+
     class style1 : public ChoiceParameters<style1> {
     public:
         auto static constexpr ID = "style1";
@@ -209,9 +293,11 @@ namespace zldsp {
         juce::AudioProcessorValueTreeState::ParameterLayout layout;
         layout.add(inputGain::get(), outputGain::get(), wet::get(),
                    curve1::get(), curve2::get(), weight::get(),
+                   sideWet::get(), sideCurve1::get(), sideCurve2::get(),
                    lowSplit::get(), highSplit::get(),
-                   effectIn::get(), bandSplit::get(), autoGain::get(),
-                   overSample::get(), style1::get(), style2::get());
+                   effectIn::get(), bandSplit::get(), channelLink::get(), midSide::get(), autoGain::get(),
+                   overSample::get(), overSampleQuality::get(), renderOverSample::get(),
+                   constantLatency::get(), lookupTable::get(), style1::get(), style2::get());
         return layout;
     }
 }
@@ -0,0 +1,81 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#ifndef ZLINFLATOR_LOUDNESSCOMPONENT_H
+#define ZLINFLATOR_LOUDNESSCOMPONENT_H
+
+#include "juce_gui_basics/juce_gui_basics.h"
+#include "interface_definitions.h"
+#include "../DSP/MeterSource.h"
+
+namespace zlinterface {
+    /**
+     * the momentary, short-term and integrated loudness and the loudness range of a meter source
+     * click to restart the integrated loudness and the loudness range
+     */
+    class LoudnessComponent : public juce::Component, private juce::Timer {
+    public:
+        explicit LoudnessComponent(MeterSource<float> *meterSource, UIBase &base) {
+            source = meterSource;
+            uiBase = &base;
+            startTimerHz(refreshFreqHz);
+        }
+
+        ~LoudnessComponent() override {
+            stopTimer();
+        }
+
+        void paint(juce::Graphics &g) override {
+            const auto &meter = source->getLoudnessMeter();
+            const std::array<std::pair<const char *, float>, 4> values{{
+                {"M", meter.getMomentary()},
+                {"S", meter.getShortTerm()},
+                {"I", meter.getIntegrated()},
+                {"LRA", meter.getLoudnessRange()}
+            }};
+            auto bound = getLocalBounds().toFloat();
+            if (uiBase->getFontSize() > 0) {
+                g.setFont(uiBase->getFontSize() * FontSmall);
+            } else {
+                g.setFont(bound.getHeight() * 0.3f);
+            }
+            const auto width = bound.getWidth() / static_cast<float>(values.size());
+            for (const auto &[name, value]: values) {
+                auto localBound = bound.removeFromLeft(width);
+                g.setColour(uiBase->getTextInactiveColor());
+                g.drawText(name, localBound.removeFromTop(localBound.getHeight() * 0.5f),
+                           juce::Justification::centred);
+                g.setColour(uiBase->getTextColor());
+                g.drawText(value <= minLoudness ? juce::String("-inf") : juce::String(value, 1), localBound,
+                           juce::Justification::centred);
+            }
+        }
+
+        void mouseDown(const juce::MouseEvent &event) override {
+            juce::ignoreUnused(event);
+            source->resetLoudness();
+        }
+
+    private:
+        static constexpr int refreshFreqHz = 10;
+        static constexpr float minLoudness = -70.f;
+        MeterSource<float> *source = nullptr;
+        UIBase *uiBase;
+
+        void timerCallback() override {
+            repaint();
+        }
+    };
+}
+
+#endif //ZLINFLATOR_LOUDNESSCOMPONENT_H
@@ -76,13 +76,11 @@ namespace zlinterface {
         }
 
         void paint(juce::Graphics &g) override {
-            auto rms = source->getDisplayRMS();
-            auto peak = source->getDisplayPeak();
-            auto peakMax = source->getPeakMax();
+            // the display state is preallocated, reading the meter does not allocate
+            const auto &display = source->updateDisplay();
             auto bound = getLocalBounds().toFloat();
             bound = bound.withTrimmedBottom(bound.getHeight() * 0.05f);
-            myLookAndFeel.drawMeters(g, bound, rms, peak, peakMax);
-            source->resetBuffer();
+            myLookAndFeel.drawMeters(g, bound, display.getRMS(), display.getPeak(), display.getPeakMax());
         }
 
         void mouseDown(const juce::MouseEvent &event) override {
@@ -14,6 +14,8 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 #include "interface_definitions.h"
 
+#include <span>
+
 namespace zlinterface {
 
     class MeterLookAndFeel : public juce::LookAndFeel_V4 {
@@ -23,9 +25,9 @@ namespace zlinterface {
         }
 
         void drawMeters(juce::Graphics &g, const juce::Rectangle<float> &bounds,
-                        const std::vector<float> &rms,
-                        const std::vector<float> &peak,
-                        const std::vector<float> &peakMax) {
+                        std::span<const float> rms,
+                        std::span<const float> peak,
+                        std::span<const float> peakMax) {
 
             auto bound = bounds.toFloat();
             bound = uiBase->getRoundedShadowRectangleArea(bound,
@@ -0,0 +1,89 @@
+/*
+==============================================================================
+Copyright (C) 2023 - zsliu98
+This file is part of ZLInflator
+
+ZLInflator is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ZLInflator is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with ZLInflator. If not, see <https://www.gnu.org/licenses/>.
+==============================================================================
+*/
+
+
+#ifndef ZLINFLATOR_STAGELOADCOMPONENT_H
+#define ZLINFLATOR_STAGELOADCOMPONENT_H
+
+#include "juce_gui_basics/juce_gui_basics.h"
+#include "interface_definitions.h"
+#include "../DSP/StageLoad.h"
+
+namespace zlinterface {
+    /**
+     * the load of each processing stage in percent of the block duration, with a bar for its share of the total
+     * the stages are timed while the component is visible, hiding it stops the timing
+     */
+    class StageLoadComponent : public juce::Component, private juce::Timer {
+    public:
+        explicit StageLoadComponent(zldsp::StageLoad &load, UIBase &base) {
+            stageLoad = &load;
+            uiBase = &base;
+            setInterceptsMouseClicks(false, false);
+        }
+
+        ~StageLoadComponent() override {
+            stopTimer();
+            stageLoad->setEnabled(false);
+        }
+
+        void paint(juce::Graphics &g) override {
+            const auto fontSize = uiBase->getFontSize();
+            auto bound = getLocalBounds().toFloat();
+            g.setColour(uiBase->getBackgroundColor().withAlpha(0.9f));
+            g.fillRoundedRectangle(bound, fontSize * 0.5f);
+            bound = bound.reduced(fontSize * 0.5f);
+            g.setFont(fontSize * FontSmall);
+
+            const auto loads = stageLoad->getLoads();
+            const auto total = stageLoad->getTotalLoad();
+            const auto rowHeight = bound.getHeight() / static_cast<float>(loads.size() + 1);
+            for (size_t i = 0; i < loads.size(); ++i) {
+                drawRow(g, bound.removeFromTop(rowHeight), zldsp::StageLoad::names[i], loads[i], total);
+            }
+            drawRow(g, bound, "Total", total, total);
+        }
+
+        void visibilityChanged() override {
+            stageLoad->setEnabled(isVisible());
+            if (isVisible()) {
+                startTimerHz(refreshFreqHz);
+            } else {
+                stopTimer();
+            }
+        }
+
+    private:
+        static constexpr int refreshFreqHz = 10;
+        zldsp::StageLoad *stageLoad;
+        UIBase *uiBase;
+
+        void drawRow(juce::Graphics &g, juce::Rectangle<float> bound, const char *name, float load, float total) {
+            g.setColour(uiBase->getTextInactiveColor());
+            g.drawText(name, bound.removeFromLeft(bound.getWidth() * 0.4f), juce::Justification::centredLeft);
+            g.setColour(uiBase->getTextColor());
+            g.drawText(juce::String(load * 100.f, 2) + " %", bound.removeFromRight(bound.getWidth() * 0.35f),
+                       juce::Justification::centredRight);
+            auto barBound = bound.withSizeKeepingCentre(bound.getWidth(), bound.getHeight() * 0.4f);
+            g.setColour(uiBase->getTextHideColor());
+            g.fillRect(barBound);
+            g.setColour(uiBase->getTextInactiveColor());
+            g.fillRect(barBound.withWidth(total > 0.f ? barBound.getWidth() * juce::jmin(1.f, load / total) : 0.f));
+        }
+
+        void timerCallback() override {
+            repaint();
+        }
+    };
+}
+
+#endif //ZLINFLATOR_STAGELOADCOMPONENT_H
@@ -14,12 +14,14 @@ You should have received a copy of the GNU General Public License along with ZLI
 
 ControlPanel::ControlPanel(juce::AudioProcessorValueTreeState &apvts, zlinterface::UIBase &base) {
     // init sliders
-    std::array<std::string, 8> rotarySliderID{zldsp::inputGain::ID, zldsp::outputGain::ID, zldsp::lowSplit::ID, zldsp::highSplit::ID,
-                        zldsp::wet::ID, zldsp::curve1::ID, zldsp::weight::ID, zldsp::curve2::ID};
-    zlpanel::attachSliders<zlinterface::RotarySliderComponent, 8>(*this, rotarySliderList, sliderAttachments, rotarySliderID,
+    std::array<std::string, 11> rotarySliderID{zldsp::inputGain::ID, zldsp::outputGain::ID, zldsp::lowSplit::ID, zldsp::highSplit::ID,
+                        zldsp::wet::ID, zldsp::curve1::ID, zldsp::weight::ID, zldsp::curve2::ID,
+                        zldsp::sideWet::ID, zldsp::sideCurve1::ID, zldsp::sideCurve2::ID};
+    zlpanel::attachSliders<zlinterface::RotarySliderComponent, 11>(*this, rotarySliderList, sliderAttachments, rotarySliderID,
                                                          apvts, base);
     // init buttons
-    std::array<std::string, 2> buttonID{zldsp::effectIn::ID, zldsp::bandSplit::ID};
+    std::array<std::string, 6> buttonID{zldsp::effectIn::ID, zldsp::bandSplit::ID, zldsp::midSide::ID,
+                                        zldsp::channelLink::ID, zldsp::constantLatency::ID, zldsp::lookupTable::ID};
     zlpanel::attachButtons(*this, buttonList, buttonAttachments, buttonID, apvts, base);
 
     // init combobox
@@ -50,7 +52,7 @@ void ControlPanel::resized() {
     using Track = juce::Grid::TrackInfo;
     using Fr = juce::Grid::Fr;
 
-    grid.templateRows = {Track(Fr(1)), Track(Fr(2)), Track(Fr(2))};
+    grid.templateRows = {Track(Fr(1)), Track(Fr(1)), Track(Fr(2)), Track(Fr(2)), Track(Fr(2))};
     grid.templateColumns = {Track(Fr(1)), Track(Fr(1)), Track(Fr(1)), Track(Fr(1))};
 
     juce::Array<juce::GridItem> items;
@@ -59,6 +61,10 @@ void ControlPanel::resized() {
     items.add(*splitButton);
     items.add(*style1Box);
     items.add(*style2Box);
+    items.add(*midSideButton);
+    items.add(*linkButton);
+    items.add(*latencyButton);
+    items.add(*tableButton);
     items.add(*inputGainSlider);
     items.add(*lowSplitSlider);
     items.add(*wetSlider);
@@ -67,6 +73,11 @@ void ControlPanel::resized() {
     items.add(*highSplitSlider);
     items.add(*curve1Slider);
     items.add(*curve2Slider);
+    // the side controls sit under the ones of the mid channel
+    items.add(juce::GridItem());
+    items.add(*sideWetSlider);
+    items.add(*sideCurve1Slider);
+    items.add(*sideCurve2Slider);
 
     grid.items = items;
     grid.performLayout(getLocalBounds());
@@ -85,6 +96,7 @@ void ControlPanel::handleParameterChanges(const juce::String &parameterID, float
         } else {
             curve1Slider->setEditable(true);
         }
+        updateSideEditable();
     } else if (parameterID == zldsp::style2::ID) {
         auto index = static_cast<int>(newValue);
         if (index == zldsp::style2::Identity || index == zldsp::style2::Quadratic || index == zldsp::style2::Cubic) {
@@ -92,13 +104,32 @@ void ControlPanel::handleParameterChanges(const juce::String &parameterID, float
         } else {
             curve2Slider->setEditable(true);
         }
+        updateSideEditable();
     } else if (parameterID == zldsp::bandSplit::ID) {
         auto f = static_cast<bool>(newValue);
         lowSplitSlider->setEditable(f);
         highSplitSlider->setEditable(f);
+    } else if (parameterID == zldsp::midSide::ID) {
+        // channel link is bypassed in mid/side mode
+        linkButton->setEditable(!static_cast<bool>(newValue));
+        updateSideEditable();
     }
 }
 
+void ControlPanel::updateSideEditable() {
+    auto midSide = parameters->getRawParameterValue(zldsp::midSide::ID)->load() > .5f;
+    auto style1 = static_cast<int>(parameters->getRawParameterValue(zldsp::style1::ID)->load());
+    auto style2 = static_cast<int>(parameters->getRawParameterValue(zldsp::style2::ID)->load());
+    sideWetSlider->setEditable(midSide);
+    sideCurve1Slider->setEditable(midSide && hasCurve(style1));
+    sideCurve2Slider->setEditable(midSide && hasCurve(style2));
+}
+
+bool ControlPanel::hasCurve(int styleIndex) {
+    return styleIndex != zldsp::style1::Identity && styleIndex != zldsp::style1::Quadratic &&
+           styleIndex != zldsp::style1::Cubic;
+}
+
 void ControlPanel::handleAsyncUpdate() {
     repaint();
 }
\ No newline at end of file
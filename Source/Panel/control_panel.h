@@ -37,16 +37,22 @@ public:
 private:
     std::unique_ptr<zlinterface::RotarySliderComponent> inputGainSlider, outputGainSlider;
     std::unique_ptr<zlinterface::RotarySliderComponent> lowSplitSlider, highSplitSlider, wetSlider, curve1Slider, weightSlider, curve2Slider;
-    std::array<std::unique_ptr<zlinterface::RotarySliderComponent> *, 8> rotarySliderList{&inputGainSlider,
-                                                                                          &outputGainSlider,
-                                                                                          &lowSplitSlider,
-                                                                                          &highSplitSlider, &wetSlider,
-                                                                                          &curve1Slider, &weightSlider,
-                                                                                          &curve2Slider};
+    std::unique_ptr<zlinterface::RotarySliderComponent> sideWetSlider, sideCurve1Slider, sideCurve2Slider;
+    std::array<std::unique_ptr<zlinterface::RotarySliderComponent> *, 11> rotarySliderList{&inputGainSlider,
+                                                                                           &outputGainSlider,
+                                                                                           &lowSplitSlider,
+                                                                                           &highSplitSlider, &wetSlider,
+                                                                                           &curve1Slider, &weightSlider,
+                                                                                           &curve2Slider, &sideWetSlider,
+                                                                                           &sideCurve1Slider,
+                                                                                           &sideCurve2Slider};
     juce::OwnedArray<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachments;
 
-    std::unique_ptr<zlinterface::ButtonComponent> effectButton, splitButton;
-    std::array<std::unique_ptr<zlinterface::ButtonComponent> *, 2> buttonList{&effectButton, &splitButton};
+    std::unique_ptr<zlinterface::ButtonComponent> effectButton, splitButton, midSideButton, linkButton;
+    std::unique_ptr<zlinterface::ButtonComponent> latencyButton, tableButton;
+    std::array<std::unique_ptr<zlinterface::ButtonComponent> *, 6> buttonList{&effectButton, &splitButton,
+                                                                              &midSideButton, &linkButton,
+                                                                              &latencyButton, &tableButton};
     juce::OwnedArray<juce::AudioProcessorValueTreeState::ButtonAttachment> buttonAttachments;
 
     std::unique_ptr<zlinterface::ComboboxComponent> style1Box, style2Box;
@@ -54,12 +60,18 @@ private:
     juce::OwnedArray<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboboxAttachments;
 
     juce::AudioProcessorValueTreeState *parameters;
-    std::array<juce::String, 3> visibleChangeIDs = {zldsp::style1::ID, zldsp::style2::ID, zldsp::bandSplit::ID};
+    std::array<juce::String, 4> visibleChangeIDs = {zldsp::style1::ID, zldsp::style2::ID, zldsp::bandSplit::ID,
+                                                    zldsp::midSide::ID};
 
     void handleAsyncUpdate() override;
 
     void handleParameterChanges(const juce::String &parameterID, float newValue);
 
+    /** the side controls follow the mid/side mode, the side curves also follow the styles */
+    void updateSideEditable();
+
+    static bool hasCurve(int styleIndex);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ControlPanel)
 };
 
@@ -55,7 +55,12 @@ namespace zlpanel {
     }
 
     void LogoPanel::mouseDoubleClick(const juce::MouseEvent &event) {
-        juce::ignoreUnused(event);
+        if (event.mods.isShiftDown()) {
+            // shift double click shows or hides the load of the processing stages
+            auto *parameter = processorRef->states.getParameter(zlstate::showLoad::ID);
+            parameter->setValueNotifyingHost(parameter->getValue() > .5f ? 0.f : 1.f);
+            return;
+        }
         auto styleID = static_cast<size_t>(*processorRef->states.getRawParameterValue(zlstate::uiStyle::ID));
         styleID = (styleID + 1) % (zlstate::uiStyle::maxV + 1);
         uiBase->setStyle(styleID);
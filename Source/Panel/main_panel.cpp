@@ -13,18 +13,25 @@ You should have received a copy of the GNU General Public License along with ZLI
 #include "main_panel.h"
 
 MainPanel::MainPanel(ZLInflatorAudioProcessor &p) :
+        processorRef(p),
         uiBase(),
         controlPanel(p.parameters, uiBase),
         topPanel(p, uiBase),
         meterPanel(p, uiBase),
-        plotPanel(p, uiBase) {
+        plotPanel(p, uiBase),
+        stageLoadOverlay(p.getStageLoad(), uiBase) {
     addAndMakeVisible(controlPanel);
     addAndMakeVisible(topPanel);
     addAndMakeVisible(meterPanel);
     addAndMakeVisible(plotPanel);
+    addChildComponent(stageLoadOverlay);
+    processorRef.states.addParameterListener(zlstate::showLoad::ID, this);
+    handleAsyncUpdate();
 }
 
-MainPanel::~MainPanel() = default;
+MainPanel::~MainPanel() {
+    processorRef.states.removeParameterListener(zlstate::showLoad::ID, this);
+}
 
 void MainPanel::paint(juce::Graphics &g) {
     g.fillAll(uiBase.getBackgroundColor());
@@ -57,4 +64,14 @@ void MainPanel::resized() {
     };
 
     grid.performLayout(bound.toNearestInt());
+    stageLoadOverlay.setBounds(plotPanel.getBounds());
+}
+
+void MainPanel::parameterChanged(const juce::String &parameterID, float newValue) {
+    juce::ignoreUnused(parameterID, newValue);
+    triggerAsyncUpdate();
+}
+
+void MainPanel::handleAsyncUpdate() {
+    stageLoadOverlay.setVisible(*processorRef.states.getRawParameterValue(zlstate::showLoad::ID) > .5f);
 }
\ No newline at end of file
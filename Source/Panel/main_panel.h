@@ -15,12 +15,15 @@ You should have received a copy of the GNU General Public License along with ZLI
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "../GUI/interface_definitions.h"
+#include "../GUI/stage_load_component.h"
 #include "control_panel.h"
 #include "top_panel.h"
 #include "meter_panel.h"
 #include "plot_panel.h"
 
-class MainPanel : public juce::Component {
+class MainPanel : public juce::Component,
+                  private juce::AudioProcessorValueTreeState::Listener,
+                  private juce::AsyncUpdater {
 public:
     explicit MainPanel(ZLInflatorAudioProcessor &p);
 
@@ -30,12 +33,19 @@ public:
 
     void resized() override;
 private:
+    ZLInflatorAudioProcessor &processorRef;
     zlinterface::UIBase uiBase;
 
     ControlPanel controlPanel;
     TopPanel topPanel;
     MeterPanel meterPanel;
     PlotPanel plotPanel;
+    // on top of the plot, shown and hidden by a shift double click on the logo
+    zlinterface::StageLoadComponent stageLoadOverlay;
+
+    void parameterChanged(const juce::String &parameterID, float newValue) override;
+
+    void handleAsyncUpdate() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainPanel)
 };
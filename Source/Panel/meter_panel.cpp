@@ -16,15 +16,20 @@ MeterPanel::MeterPanel(ZLInflatorAudioProcessor &p, zlinterface::UIBase &base) :
         inputBackground("IN", base),
         outputBackground("OUT", base),
         inputMeter(p.getInputMeterSource(), -40.0f, 0.0f, base),
-        outputMeter(p.getOutputMeterSource(), -40.0f, 0.0f, base) {
+        outputMeter(p.getOutputMeterSource(), -40.0f, 0.0f, base),
+        outputLoudness(p.getOutputMeterSource(), base) {
     addAndMakeVisible(inputBackground);
     addAndMakeVisible(outputBackground);
     addAndMakeVisible(inputMeter);
     addAndMakeVisible(outputMeter);
+    addAndMakeVisible(outputLoudness);
 
     // init buttons
     std::array<std::string, 1> buttonID{zldsp::autoGain::ID};
     zlpanel::attachButtons(*this, buttonList, buttonAttachments, buttonID, p.parameters, base);
+    // true peak only changes what the meters show, so it is a state rather than a parameter
+    std::array<std::string, 1> stateButtonID{zlstate::truePeak::ID};
+    zlpanel::attachButtons(*this, stateButtonList, buttonAttachments, stateButtonID, p.states, base);
 }
 
 MeterPanel::~MeterPanel() = default;
@@ -35,7 +40,10 @@ void MeterPanel::resized() {
     auto bound = getLocalBounds().toFloat();
     auto buttonBound = bound.removeFromTop(bound.getHeight() * 0.2f);
     buttonBound = buttonBound.withSizeKeepingCentre(buttonBound.getWidth() * 0.8333f, buttonBound.getHeight());
-    compensationButton->setBounds(buttonBound.toNearestInt());
+    compensationButton->setBounds(buttonBound.removeFromLeft(buttonBound.getWidth() * 0.5f).toNearestInt());
+    truePeakButton->setBounds(buttonBound.toNearestInt());
+    auto loudnessBound = bound.removeFromTop(bound.getHeight() * 0.1f);
+    outputLoudness.setBounds(loudnessBound.toNearestInt());
     auto inputBound = bound.removeFromLeft(bound.getWidth() * 0.5f);
     inputBackground.setBounds(inputBound.toNearestInt());
     outputBackground.setBounds(bound.toNearestInt());
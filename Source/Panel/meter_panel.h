@@ -15,6 +15,7 @@ You should have received a copy of the GNU General Public License along with ZLI
 
 #include "../DSP/MeterSource.h"
 #include "../GUI/meter_component.h"
+#include "../GUI/loudness_component.h"
 #include "../GUI/button_component.h"
 #include "../GUI/interface_definitions.h"
 #include "../PluginProcessor.h"
@@ -33,9 +34,11 @@ public:
 private:
     zlinterface::MeterBackgroundComponent inputBackground, outputBackground;
     zlinterface::MeterComponent inputMeter, outputMeter;
+    zlinterface::LoudnessComponent outputLoudness;
 
-    std::unique_ptr<zlinterface::ButtonComponent> compensationButton;
+    std::unique_ptr<zlinterface::ButtonComponent> compensationButton, truePeakButton;
     std::array<std::unique_ptr<zlinterface::ButtonComponent> *, 1> buttonList{&compensationButton};
+    std::array<std::unique_ptr<zlinterface::ButtonComponent> *, 1> stateButtonList{&truePeakButton};
     juce::OwnedArray<juce::AudioProcessorValueTreeState::ButtonAttachment> buttonAttachments;
 };
 
@@ -14,8 +14,9 @@ You should have received a copy of the GNU General Public License along with ZLI
 
 PlotPanel::PlotPanel(ZLInflatorAudioProcessor &p,
                      zlinterface::UIBase &base) :
-        shaperPlotComponent(p.getShaperMixer(), base) {
+        shaperPlotComponent(&shaperMixer, base) {
     processorRef = &p;
+    updateShaperMixer();
     addAndMakeVisible(shaperPlotComponent);
 
     for (const auto &isPlotChangedParaID: isPlotChangedParaIDs) {
@@ -44,5 +45,16 @@ void PlotPanel::resized() {
 }
 
 void PlotPanel::handleAsyncUpdate() {
+    updateShaperMixer();
     repaint();
+}
+
+void PlotPanel::updateShaperMixer() {
+    auto &apvts = processorRef->parameters;
+    shaperMixer.setShapes(zldsp::curve1::formatV(apvts.getRawParameterValue(zldsp::curve1::ID)->load()),
+                          zldsp::curve2::formatV(apvts.getRawParameterValue(zldsp::curve2::ID)->load()),
+                          zldsp::weight::formatV(apvts.getRawParameterValue(zldsp::weight::ID)->load()),
+                          static_cast<bool>(apvts.getRawParameterValue(zldsp::autoGain::ID)->load()));
+    shaperMixer.setTypes(static_cast<size_t>(apvts.getRawParameterValue(zldsp::style1::ID)->load()),
+                         static_cast<size_t>(apvts.getRawParameterValue(zldsp::style2::ID)->load()));
 }
\ No newline at end of file
@@ -33,12 +33,16 @@ public:
 
 private:
     ZLInflatorAudioProcessor *processorRef;
+    // a copy of the curve for drawing, so that the GUI never reads the DSP state
+    shaper::ShaperMixer<float> shaperMixer;
     zlinterface::ShaperPlotComponent shaperPlotComponent;
     std::array<juce::String, 6> isPlotChangedParaIDs{zldsp::curve1::ID, zldsp::curve2::ID,
                                                      zldsp::weight::ID, zldsp::autoGain::ID,
                                                      zldsp::style1::ID, zldsp::style2::ID};
 
     void handleAsyncUpdate() override;
+
+    void updateShaperMixer();
 };
 
 
@@ -17,7 +17,7 @@ TopPanel::TopPanel(ZLInflatorAudioProcessor &p,
         logoPanel(p, base) {
     uiBase = &base;
     // init combobox
-    std::array<std::string, 1> comboboxID{"over_sample"};
+    std::array<std::string, 3> comboboxID{"over_sample", "over_sample_quality", "render_over_sample"};
     zlpanel::attachBoxes(*this, comboBoxList, comboboxAttachments, comboboxID, p.parameters, base);
     addAndMakeVisible(logoPanel);
 }
@@ -27,6 +27,8 @@ TopPanel::~TopPanel() = default;
 void TopPanel::paint(juce::Graphics &g) { juce::ignoreUnused(g); }
 
 void TopPanel::resized() {
-    logoPanel.setBoundsRelative(0.f, 0.0f, 0.582f, 1.0f);
-    sampleRateCombobox->setBoundsRelative(0.583f, 0.0f, 0.416f, 1.0f);
+    logoPanel.setBoundsRelative(0.f, 0.0f, 0.499f, 1.0f);
+    sampleRateCombobox->setBoundsRelative(0.5f, 0.0f, 0.166f, 1.0f);
+    qualityCombobox->setBoundsRelative(0.667f, 0.0f, 0.166f, 1.0f);
+    renderCombobox->setBoundsRelative(0.833f, 0.0f, 0.166f, 1.0f);
 }
\ No newline at end of file
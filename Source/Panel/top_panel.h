@@ -32,8 +32,10 @@ public:
     void resized() override;
 
 private:
-    std::unique_ptr<zlinterface::ComboboxComponent> sampleRateCombobox;
-    std::array<std::unique_ptr<zlinterface::ComboboxComponent> *, 1> comboBoxList{&sampleRateCombobox};
+    std::unique_ptr<zlinterface::ComboboxComponent> sampleRateCombobox, qualityCombobox, renderCombobox;
+    std::array<std::unique_ptr<zlinterface::ComboboxComponent> *, 3> comboBoxList{&sampleRateCombobox,
+                                                                                  &qualityCombobox,
+                                                                                  &renderCombobox};
     juce::OwnedArray<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboboxAttachments;
 
     zlinterface::UIBase *uiBase;
@@ -40,7 +40,8 @@ private:
     MainPanel mainPanel;
     juce::Value lastUIWidth, lastUIHeight;
     constexpr const static std::array IDs{zlstate::uiStyle::ID,
-                                          zlstate::windowW::ID, zlstate::windowH::ID};
+                                          zlstate::windowW::ID, zlstate::windowH::ID,
+                                          zlstate::showLoad::ID, zlstate::truePeak::ID};
 
     void valueChanged(juce::Value &) override;
 
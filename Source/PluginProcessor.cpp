@@ -29,13 +29,14 @@ ZLInflatorAudioProcessor::ZLInflatorAudioProcessor()
           dummyProcessor(),
           parameters(*this, nullptr, juce::Identifier("ZLInflatorParameters"), zldsp::getParameterLayout()),
           states(dummyProcessor, nullptr, juce::Identifier("ZLInflatorStates"), zlstate::getParameterLayout()),
-          waveShaper(*this),
-          waveShaperAttach(waveShaper, parameters) {
-    inGain.setGainDecibels(zldsp::inputGain::defaultV);
-    outGain.setGainDecibels(zldsp::outputGain::defaultV);
-    parameters.addParameterListener(zldsp::inputGain::ID, this);
-    parameters.addParameterListener(zldsp::outputGain::ID, this);
-    waveShaperAttach.addListeners();
+          shaperAttach(shaperState, parameters) {
+    shaperAttach.addListeners();
+    inGainDB = parameters.getRawParameterValue(zldsp::inputGain::ID);
+    outGainDB = parameters.getRawParameterValue(zldsp::outputGain::ID);
+    channelLink = parameters.getRawParameterValue(zldsp::channelLink::ID);
+    truePeak = states.getRawParameterValue(zlstate::truePeak::ID);
+    // the output feeds the limiter, so that is where the loudness targets apply
+    meterOut.setLoudness(true);
 }
 
 ZLInflatorAudioProcessor::~ZLInflatorAudioProcessor() = default;
@@ -100,19 +101,62 @@ void ZLInflatorAudioProcessor::prepareToPlay(double sampleRate,
     auto channels = static_cast<juce::uint32> (juce::jmin(getMainBusNumInputChannels(), getMainBusNumOutputChannels()));
     juce::dsp::ProcessSpec spec{sampleRate, static_cast<juce::uint32> (samplesPerBlock), channels};
 
-    inGain.prepare(spec);
-    outGain.prepare(spec);
     meterIn.prepare(spec);
     meterOut.prepare(spec);
-    waveShaper.prepare(spec);
+    stageLoad.prepare(sampleRate);
+    numGroups = juce::jmax(static_cast<size_t>(1), (static_cast<size_t>(channels) + groupSize - 1) / groupSize);
+    const auto numCores = static_cast<size_t>(juce::jmax(1, juce::SystemStats::getNumCpus() - 1));
+    workerPool.setNumWorkers(juce::jmin(numGroups - 1, maxWorkers, numCores), samplesPerBlock, sampleRate);
+    // merge what changed since the last update, then keep merging on the message thread
+    shaperState.update();
+    shaperState.startUpdates();
+    // the host picks the precision before prepareToPlay, the other chain holds no shapers
+    if (isUsingDoublePrecision()) {
+        floatChain.releaseShapers();
+        prepareChain(doubleChain, spec);
+    } else {
+        doubleChain.releaseShapers();
+        prepareChain(floatChain, spec);
+    }
+}
+
+template<typename FloatType>
+void ZLInflatorAudioProcessor::prepareChain(ProcessChain<FloatType> &chain, const juce::dsp::ProcessSpec &spec) {
+    chain.inGain.prepare(spec);
+    chain.outGain.prepare(spec);
+    for (size_t i = 0; i < chain.shapers.size(); ++i) {
+        auto &shaper = chain.shapers[i];
+        // linked mode needs every channel in one shaper, which the first pair already is up to stereo
+        const auto linkShaper = i == maxGroups;
+        if (linkShaper ? numGroups == 1 : i >= numGroups) {
+            shaper.reset();
+            continue;
+        }
+        if (shaper == nullptr) {
+            shaper = std::make_unique<WaveShaper<FloatType>>(*this, shaperState);
+            shaper->setStageTiming(chain.stageTiming);
+            shaper->setLinkOnly(linkShaper);
+        }
+        const auto numChannels = static_cast<size_t>(spec.numChannels);
+        const auto shaperChannels = linkShaper ? numChannels : juce::jmin(groupSize, numChannels - i * groupSize);
+        shaper->prepare({spec.sampleRate, spec.maximumBlockSize, static_cast<juce::uint32>(shaperChannels)});
+    }
 }
 
 void ZLInflatorAudioProcessor::reset() {
-    inGain.reset();
-    outGain.reset();
     meterIn.reset();
     meterOut.reset();
-    waveShaper.reset();
+    floatChain.inGain.reset();
+    floatChain.outGain.reset();
+    forEachShaper(floatChain, [](auto &shaper) { shaper.reset(); });
+    doubleChain.inGain.reset();
+    doubleChain.outGain.reset();
+    forEachShaper(doubleChain, [](auto &shaper) { shaper.reset(); });
+}
+
+void ZLInflatorAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept {
+    juce::AudioProcessor::setNonRealtime(isNonRealtime);
+    shaperState.setNonRealtime(isNonRealtime);
 }
 
 void ZLInflatorAudioProcessor::releaseResources() {
@@ -126,30 +170,121 @@ bool ZLInflatorAudioProcessor::isBusesLayoutSupported(
         const BusesLayout &layouts) const {
     if (layouts.getMainInputChannelSet() != layouts.getMainOutputChannelSet())
         return false;
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() &&
-        layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-    return true;
+    // any layout up to 7.1.4 or 16 discrete channels
+    const auto numChannels = static_cast<size_t>(layouts.getMainOutputChannelSet().size());
+    return numChannels > 0 && numChannels <= maxChannels;
 }
 
 #endif
 
 void ZLInflatorAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                             juce::MidiBuffer &midiMessages) {
-    juce::ScopedNoDenormals noDenormals;
     juce::ignoreUnused(midiMessages);
+    processChain(floatChain, buffer);
+}
+
+void ZLInflatorAudioProcessor::processBlock(juce::AudioBuffer<double> &buffer,
+                                            juce::MidiBuffer &midiMessages) {
+    juce::ignoreUnused(midiMessages);
+    processChain(doubleChain, buffer);
+}
+
+template<typename FloatType>
+void ZLInflatorAudioProcessor::processChain(ProcessChain<FloatType> &chain, juce::AudioBuffer<FloatType> &buffer) {
+    ZL_REALTIME_AUDIT_SECTION;
+    juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    juce::dsp::AudioBlock<float> block(buffer);
-    inGain.process(juce::dsp::ProcessContextReplacing<float>(block));
-    meterIn.process(juce::dsp::ProcessContextReplacing<float>(block));
-    waveShaper.process(juce::dsp::ProcessContextReplacing<float>(block));
-    outGain.process(juce::dsp::ProcessContextReplacing<float>(block));
-    meterOut.process(juce::dsp::ProcessContextReplacing<float>(block));
+    chain.inGain.setGainDecibels(static_cast<FloatType>(inGainDB->load()));
+    chain.outGain.setGainDecibels(static_cast<FloatType>(outGainDB->load()));
+    const auto measureTruePeak = truePeak->load() > .5f;
+    meterIn.setTruePeak(measureTruePeak);
+    meterOut.setTruePeak(measureTruePeak);
+
+    const auto timing = stageLoad.isEnabled();
+    if (timing != chain.stageTiming) {
+        chain.stageTiming = timing;
+        forEachShaper(chain, [=](auto &shaper) { shaper.setStageTiming(timing); });
+    }
+    zldsp::StageLoad::Ticks ticks{};
+    zldsp::StageLoad::Clock clock(ticks, timing);
+
+    juce::dsp::AudioBlock<FloatType> block(buffer);
+    juce::dsp::ProcessContextReplacing<FloatType> context(block);
+    chain.inGain.process(context);
+    clock.lap(zldsp::StageLoad::inGain);
+    meterIn.process(context);
+    clock.lap(zldsp::StageLoad::meterIn);
+    // the shapers time their own stages, possibly on the worker threads
+    processShapers(chain, block);
+    clock.restart();
+    chain.outGain.process(context);
+    clock.lap(zldsp::StageLoad::outGain);
+    meterOut.process(context);
+    clock.lap(zldsp::StageLoad::meterOut);
+
+    if (timing) {
+        forEachShaper(chain, [&](auto &shaper) {
+            const auto shaperTicks = shaper.takeStageTicks();
+            for (size_t i = 0; i < ticks.size(); ++i) {
+                ticks[i] += shaperTicks[i];
+            }
+        });
+        stageLoad.update(ticks, static_cast<size_t>(buffer.getNumSamples()));
+    }
+}
+
+template<typename FloatType>
+void ZLInflatorAudioProcessor::processShapers(ProcessChain<FloatType> &chain, juce::dsp::AudioBlock<FloatType> &block) {
+    // not prepared in this precision
+    if (chain.shapers[0] == nullptr) {
+        return;
+    }
+    if (numGroups == 1) {
+        auto &shaper = *chain.shapers[0];
+        shaper.process(juce::dsp::ProcessContextReplacing<FloatType>(block));
+        overSamplerLoad.store(shaper.getSamplerLoad(), std::memory_order_relaxed);
+        return;
+    }
+    // the linked shaper gets its oversampler on the message thread once channel link is on,
+    // until then the pairs go on
+    auto &linkShaper = *chain.shapers[maxGroups];
+    const auto linked = channelLink->load() > .5f && linkShaper.isReady();
+    if (linked != chain.linked) {
+        chain.linked = linked;
+        // the channels move to other shapers, so their filter states start over
+        forEachShaper(chain, [](auto &shaper) { shaper.reset(); });
+    }
+    if (linked) {
+        linkShaper.process(juce::dsp::ProcessContextReplacing<FloatType>(block));
+        overSamplerLoad.store(linkShaper.getSamplerLoad(), std::memory_order_relaxed);
+        return;
+    }
+    linkShaper.idle();
+    const auto numChannels = block.getNumChannels();
+    auto processGroup = [&](size_t group) {
+        const auto start = group * groupSize;
+        auto groupBlock = block.getSubsetChannelBlock(start, juce::jmin(groupSize, numChannels - start));
+        chain.shapers[group]->process(juce::dsp::ProcessContextReplacing<FloatType>(groupBlock));
+    };
+    // the oversampler in use, while rendering offline it runs at the render factor
+    const auto factor = chain.shapers[0]->getActiveFactor();
+    if (numChannels * factor >= parallelLoad && workerPool.getNumWorkers() > 0) {
+        workerPool.run(numGroups, processGroup);
+    } else {
+        for (size_t group = 0; group < numGroups; ++group) {
+            processGroup(group);
+        }
+    }
+    float load = 0.f;
+    for (size_t group = 0; group < numGroups; ++group) {
+        load += chain.shapers[group]->getSamplerLoad();
+    }
+    overSamplerLoad.store(load, std::memory_order_relaxed);
 }
 
 //==============================================================================
@@ -194,14 +329,21 @@ MeterSource<float> *ZLInflatorAudioProcessor::getOutputMeterSource() {
     return &meterOut;
 }
 
-shaper::ShaperMixer<float> *ZLInflatorAudioProcessor::getShaperMixer() {
-    return waveShaper.getShaper();
+size_t ZLInflatorAudioProcessor::getMemoryUsage() {
+    size_t bytes = sizeof(*this);
+    forEachShaper(floatChain, [&](auto &shaper) { bytes += sizeof(shaper) + shaper.getMemoryUsage(); });
+    forEachShaper(doubleChain, [&](auto &shaper) { bytes += sizeof(shaper) + shaper.getMemoryUsage(); });
+    return bytes;
 }
 
-void ZLInflatorAudioProcessor::parameterChanged(const juce::String &parameterID, float newValue) {
-    if (parameterID.equalsIgnoreCase(zldsp::inputGain::ID)) {
-        inGain.setGainDecibels(newValue);
-    } else if (parameterID.equalsIgnoreCase(zldsp::outputGain::ID)) {
-        outGain.setGainDecibels(newValue);
-    }
-}
\ No newline at end of file
+float ZLInflatorAudioProcessor::getOverSamplerLoad() const {
+    return overSamplerLoad.load(std::memory_order_relaxed);
+}
+
+void ZLInflatorAudioProcessor::audioWorkgroupContextChanged(const juce::AudioWorkgroup &workgroup) {
+    workerPool.setWorkgroup(workgroup);
+}
+
+zldsp::StageLoad &ZLInflatorAudioProcessor::getStageLoad() {
+    return stageLoad;
+}
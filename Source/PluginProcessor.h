@@ -14,7 +14,10 @@ You should have received a copy of the GNU General Public License along with ZLI
 
 #include "DSP/dsp_defines.h"
 #include "DSP/MeterSource.h"
+#include "DSP/RealtimeAudit.h"
+#include "DSP/StageLoad.h"
 #include "DSP/WaveShaper.h"
+#include "DSP/WorkerPool.h"
 #include "GUI/interface_definitions.h"
 #include "State/dummy_processor.h"
 #include "State/state_definitions.h"
@@ -24,8 +27,7 @@ You should have received a copy of the GNU General Public License along with ZLI
 //==============================================================================
 /**
  */
-class ZLInflatorAudioProcessor : public juce::AudioProcessor,
-                                 public juce::AudioProcessorValueTreeState::Listener
+class ZLInflatorAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
     ,
                                  public juce::AudioProcessorARAExtension
@@ -56,8 +58,14 @@ public:
 
     void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
 
+    void processBlock(juce::AudioBuffer<double> &, juce::MidiBuffer &) override;
+
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
     void reset() override;
 
+    void setNonRealtime(bool isNonRealtime) noexcept override;
+
     //==============================================================================
     juce::AudioProcessorEditor *createEditor() override;
 
@@ -94,17 +102,87 @@ public:
 
     MeterSource<float> *getOutputMeterSource();
 
-    shaper::ShaperMixer<float> *getShaperMixer();
+    /** approximate memory held by this instance in bytes, call it on the message thread */
+    size_t getMemoryUsage();
+
+    /** time spent in the oversampling filters of every active shaper, as a fraction of the block duration */
+    float getOverSamplerLoad() const;
+
+    /** the worker threads join the workgroup of the host audio thread */
+    void audioWorkgroupContextChanged(const juce::AudioWorkgroup &workgroup) override;
 
-    void parameterChanged(const juce::String &parameterID, float newValue) override;
+    /**
+     * the load of each stage of processBlock as a fraction of the block duration
+     * the stages are only timed after getStageLoad().setEnabled(true)
+     */
+    zldsp::StageLoad &getStageLoad();
 
 
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ZLInflatorAudioProcessor)
 
-    juce::dsp::Gain<float> inGain, outGain;
+    // unlinked channels are shaped in pairs, each pair by its own shaper
+    constexpr static const size_t maxChannels = WaveShaper<float>::maxChannels, groupSize = 2,
+            maxGroups = maxChannels / groupSize;
+    // the pairs go to the worker pool once channels * oversampling factor reaches it
+    constexpr static const size_t parallelLoad = 16, maxWorkers = 3;
+
+    /**
+     * the gains and the shapers in one precision, only the chain the host uses holds shapers
+     * unlinked, shapers[i] takes the pair i, linked, shapers[maxGroups] takes every channel,
+     * it only holds oversamplers while channel link is on
+     * up to stereo, shapers[0] takes both modes
+     * the shapers are created in prepareToPlay for the channels of the bus, the others stay null
+     */
+    template<typename FloatType>
+    struct ProcessChain {
+        juce::dsp::Gain<FloatType> inGain, outGain;
+        std::array<std::unique_ptr<WaveShaper<FloatType>>, maxGroups + 1> shapers;
+        bool linked = zldsp::channelLink::defaultV;
+        bool stageTiming = false;
+
+        ProcessChain() {
+            inGain.setGainDecibels(static_cast<FloatType>(zldsp::inputGain::defaultV));
+            outGain.setGainDecibels(static_cast<FloatType>(zldsp::outputGain::defaultV));
+        }
+
+        void releaseShapers() {
+            for (auto &shaper: shapers) {
+                shaper.reset();
+            }
+        }
+    };
+
+    std::atomic<float> *inGainDB, *outGainDB, *channelLink, *truePeak;
+    // the oversampler load of the shapers that ran in the last block, summed
+    std::atomic<float> overSamplerLoad{0.f};
+    size_t numGroups = 1;
+    zldsp::WorkerPool workerPool;
+    // the meters keep float levels and accept blocks of either precision
     MeterSource<float> meterIn, meterOut;
-    WaveShaper<float> waveShaper;
-    WaveShaperAttach<float> waveShaperAttach;
+    zldsp::StageLoad stageLoad;
+    // the shaper parameters, written by a single attach and read by every shaper
+    WaveShaperState shaperState;
+    WaveShaperAttach shaperAttach;
+    ProcessChain<float> floatChain;
+    ProcessChain<double> doubleChain;
+
+    template<typename FloatType>
+    void prepareChain(ProcessChain<FloatType> &chain, const juce::dsp::ProcessSpec &spec);
+
+    template<typename FloatType>
+    void processChain(ProcessChain<FloatType> &chain, juce::AudioBuffer<FloatType> &buffer);
+
+    template<typename FloatType>
+    void processShapers(ProcessChain<FloatType> &chain, juce::dsp::AudioBlock<FloatType> &block);
+
+    template<typename FloatType, typename Func>
+    static void forEachShaper(ProcessChain<FloatType> &chain, Func &&func) {
+        for (auto &shaper: chain.shapers) {
+            if (shaper != nullptr) {
+                func(*shaper);
+            }
+        }
+    }
 };
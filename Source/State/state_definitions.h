@@ -96,6 +96,20 @@ namespace zlstate {
         }
     };
 
+    class showLoad : public BoolParameters<showLoad> {
+    public:
+        auto static constexpr ID = "show_load";
+        auto static constexpr name = "NA";
+        inline static const bool defaultV = false;
+    };
+
+    class truePeak : public BoolParameters<truePeak> {
+    public:
+        auto static constexpr ID = "true_peak";
+        auto static constexpr name = "NA";
+        inline static const bool defaultV = false;
+    };
+
     // choice
     template<class T>
     class ChoiceParameters {
@@ -116,7 +130,8 @@ namespace zlstate {
     inline juce::AudioProcessorValueTreeState::ParameterLayout getParameterLayout() {
         juce::AudioProcessorValueTreeState::ParameterLayout layout;
         layout.add(uiStyle::get(false),
-                   windowW::get(false), windowH::get(false));
+                   windowW::get(false), windowH::get(false),
+                   showLoad::get(false), truePeak::get("True Peak", false));
         return layout;
     }
 }
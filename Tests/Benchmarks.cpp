@@ -2,13 +2,20 @@
 #include "catch2/benchmark/catch_benchmark_all.hpp"
 #include "catch2/catch_test_macros.hpp"
 
-TEST_CASE ("Boot performance")
+#include <iomanip>
+#include <iostream>
+
+// Built as the Benchmarks target, run it in a release build:
+//   Benchmarks                    everything
+//   Benchmarks "[throughput]"     the processBlock throughput grid only
+
+TEST_CASE ("Boot performance", "[boot]")
 {
     BENCHMARK_ADVANCED ("Processor constructor")
     (Catch::Benchmark::Chronometer meter)
     {
         auto gui = juce::ScopedJuceInitialiser_GUI {};
-        std::vector<Catch::Benchmark::storage_for<PluginProcessor>> storage (size_t (meter.runs()));
+        std::vector<Catch::Benchmark::storage_for<ZLInflatorAudioProcessor>> storage (size_t (meter.runs()));
         meter.measure ([&] (int i) { storage[(size_t) i].construct(); });
     };
 
@@ -16,7 +23,7 @@ TEST_CASE ("Boot performance")
     (Catch::Benchmark::Chronometer meter)
     {
         auto gui = juce::ScopedJuceInitialiser_GUI {};
-        std::vector<Catch::Benchmark::destructable_object<PluginProcessor>> storage (size_t (meter.runs()));
+        std::vector<Catch::Benchmark::destructable_object<ZLInflatorAudioProcessor>> storage (size_t (meter.runs()));
         for (auto& s : storage)
             s.construct();
         meter.measure ([&] (int i) { storage[(size_t) i].destruct(); });
@@ -27,7 +34,7 @@ TEST_CASE ("Boot performance")
     {
         auto gui = juce::ScopedJuceInitialiser_GUI {};
 
-        PluginProcessor plugin;
+        ZLInflatorAudioProcessor plugin;
 
         // due to complex construction logic of the editor, let's measure open/close together
         meter.measure ([&] (int i) {
@@ -38,3 +45,132 @@ TEST_CASE ("Boot performance")
         });
     };
 }
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    struct Config
+    {
+        int overSample = 0;
+        bool split = false;
+        int style1 = 0, style2 = 0;
+        int blockSize = 512;
+        int numChannels = 2;
+    };
+
+    void setParameter (ZLInflatorAudioProcessor& processor, const char* ID, float value)
+    {
+        auto* parameter = processor.parameters.getParameter (ID);
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    template <typename FloatType>
+    std::unique_ptr<ZLInflatorAudioProcessor> createProcessor (const Config& config)
+    {
+        auto processor = std::make_unique<ZLInflatorAudioProcessor>();
+        const auto channelSet = config.numChannels == 1 ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo();
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (channelSet);
+        layout.outputBuses.add (channelSet);
+        processor->setBusesLayout (layout);
+        processor->setProcessingPrecision (std::is_same_v<FloatType, double> ? juce::AudioProcessor::doublePrecision
+                                                                             : juce::AudioProcessor::singlePrecision);
+        // set before prepareToPlay, so the oversampler is built there
+        setParameter (*processor, zldsp::overSample::ID, static_cast<float> (config.overSample));
+        setParameter (*processor, zldsp::bandSplit::ID, config.split ? 1.f : 0.f);
+        setParameter (*processor, zldsp::style1::ID, static_cast<float> (config.style1));
+        setParameter (*processor, zldsp::style2::ID, static_cast<float> (config.style2));
+        processor->prepareToPlay (sampleRate, config.blockSize);
+        return processor;
+    }
+
+    template <typename FloatType>
+    void fillNoise (juce::AudioBuffer<FloatType>& buffer)
+    {
+        juce::Random random (42);
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample (ch, i, static_cast<FloatType> (random.nextFloat() * 2.f - 1.f));
+    }
+
+    /**
+     * samples per channel processed per second, the best of a few runs of half a second of audio each
+     * the noise is refilled outside of the timing, so every block sees fresh input
+     */
+    double measureThroughput (const Config& config)
+    {
+        auto processor = createProcessor<float> (config);
+        juce::AudioBuffer<float> source (config.numChannels, config.blockSize), buffer (config.numChannels, config.blockSize);
+        juce::MidiBuffer midi;
+        fillNoise (source);
+        const auto numBlocks = juce::jmax (1, static_cast<int> (0.5 * sampleRate) / config.blockSize);
+        double best = 0.0;
+        for (int run = 0; run < 4; ++run)
+        {
+            juce::int64 ticks = 0;
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                buffer.makeCopyOf (source, true);
+                const auto start = juce::Time::getHighResolutionTicks();
+                processor->processBlock (buffer, midi);
+                ticks += juce::Time::getHighResolutionTicks() - start;
+            }
+            // the first run warms up the caches and is not counted
+            if (run > 0 && ticks > 0)
+                best = juce::jmax (best, static_cast<double> (numBlocks * config.blockSize) / juce::Time::highResolutionTicksToSeconds (ticks));
+        }
+        return best;
+    }
+}
+
+TEST_CASE ("processBlock throughput", "[throughput]")
+{
+    std::cout << "factor split style1   style2    block ch    samples/s  realtime\n";
+    for (int overSample = 0; overSample < zldsp::overSample::choices.size(); ++overSample)
+        for (const auto split : { false, true })
+            for (int style1 = 0; style1 < zldsp::style1::choices.size(); ++style1)
+                for (int style2 = 0; style2 < zldsp::style2::choices.size(); ++style2)
+                    for (int blockSize = 32; blockSize <= 4096; blockSize *= 2)
+                        for (const auto numChannels : { 1, 2 })
+                        {
+                            const Config config { overSample, split, style1, style2, blockSize, numChannels };
+                            const auto throughput = measureThroughput (config);
+                            CHECK (throughput > 0.0);
+                            std::cout << std::left << std::setw (7) << zldsp::overSample::choices[overSample]
+                                      << std::setw (6) << (split ? "on" : "off")
+                                      << std::setw (9) << zldsp::style1::choices[style1]
+                                      << std::setw (10) << zldsp::style2::choices[style2]
+                                      << std::right << std::setw (5) << blockSize
+                                      << std::setw (3) << numChannels
+                                      << std::setw (13) << std::fixed << std::setprecision (0) << throughput
+                                      << std::setw (9) << std::setprecision (1) << throughput / sampleRate << "x\n";
+                        }
+}
+
+TEST_CASE ("Float and double processBlock per oversampling factor", "[precision]")
+{
+    for (int overSample = 0; overSample < zldsp::overSample::choices.size(); ++overSample)
+    {
+        const Config config { overSample };
+        auto floatProcessor = createProcessor<float> (config);
+        auto doubleProcessor = createProcessor<double> (config);
+        juce::AudioBuffer<float> floatBuffer (config.numChannels, config.blockSize);
+        juce::AudioBuffer<double> doubleBuffer (config.numChannels, config.blockSize);
+        fillNoise (floatBuffer);
+        fillNoise (doubleBuffer);
+        juce::MidiBuffer midi;
+
+        const auto suffix = " " + zldsp::overSample::choices[overSample].toStdString() + ", 512 samples";
+        BENCHMARK (("float" + suffix).c_str())
+        {
+            floatProcessor->processBlock (floatBuffer, midi);
+            return floatBuffer.getSample (0, 0);
+        };
+        BENCHMARK (("double" + suffix).c_str())
+        {
+            doubleProcessor->processBlock (doubleBuffer, midi);
+            return doubleBuffer.getSample (0, 0);
+        };
+    }
+}
@@ -0,0 +1,300 @@
+#include "ReferenceShaper.h"
+#include <DSP/ShaperTable.h>
+#include <OfflineRenderer.h>
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+
+// Golden-output regression tests, run them before accepting a rewrite of WaveShaper or ShaperMixer.
+// The kernels are checked against the frozen scalar kernel in ReferenceShaper.h.
+// The whole processor is checked against the renders stored in Tests/Golden, one WAV per configuration and signal.
+// A missing render fails the test. Set ZL_UPDATE_GOLDEN=1 to record all of them again after an intended
+// change of the sound, or after adding a configuration, then commit Tests/Golden.
+namespace
+{
+  constexpr double sampleRate = 48000.0;
+  constexpr int numSamples = 2048;
+
+  enum Signal
+  {
+    sweep,
+    noise,
+    impulse,
+    square,
+    signalNUM
+  };
+
+  const std::array<const char*, signalNUM> signalNames{"sweep", "noise", "impulse", "square"};
+
+  // deterministic on every platform, noise and square go past full scale to reach the clipped part of the curve
+  // the raw output of minstd_rand is fixed by the standard, unlike the distributions
+  std::vector<double> makeSignal(Signal signal)
+  {
+    std::vector<double> samples(numSamples);
+    std::minstd_rand random(2023);
+    constexpr auto randomRange = static_cast<double>(std::minstd_rand::max() - std::minstd_rand::min());
+    const auto length = static_cast<double>(numSamples) / sampleRate;
+    const auto logRatio = std::log(20000.0 / 20.0);
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+      const auto t = static_cast<double>(i) / sampleRate;
+      switch (signal)
+      {
+        case sweep:
+          samples[i] = 0.9 * std::sin(juce::MathConstants<double>::twoPi * 20.0 * length / logRatio * (std::exp(t / length * logRatio) - 1.0));
+          break;
+        case noise:
+          samples[i] = 1.2 * (2.0 * static_cast<double>(random() - std::minstd_rand::min()) / randomRange - 1.0);
+          break;
+        case impulse:
+          samples[i] = i % 512 == 0 ? ((i / 512) % 2 == 0 ? 1.0 : -1.0) : 0.0;
+          break;
+        case square:
+          samples[i] = (i / 32) % 2 == 0 ? 1.0 : -1.0;
+          break;
+        default:
+          break;
+      }
+    }
+    return samples;
+  }
+
+  struct Result
+  {
+    double maxError = 0.0;
+    size_t position = 0;
+
+    void add(double actual, double expected, size_t i)
+    {
+      if (const auto error = std::abs(actual - expected); error > maxError)
+      {
+        maxError = error;
+        position = i;
+      }
+    }
+  };
+
+  struct KernelConfiguration
+  {
+    float curve1, curve2, weight;
+    bool compensation;
+    // per precision, the fused polynomial and the float fastSin approximation round differently from the reference
+    double floatTolerance, doubleTolerance;
+  };
+
+  // blocks of an odd length, so that the SIMD body starts at every alignment
+  constexpr size_t kernelBlockSize = 251;
+
+  template <typename FloatType>
+  void checkKernels(const KernelConfiguration& configuration)
+  {
+    const auto tolerance = std::is_same_v<FloatType, float> ? configuration.floatTolerance : configuration.doubleTolerance;
+    const auto weight = static_cast<FloatType>(configuration.weight);
+    shaper::ShaperMixer<FloatType> mixer, previous;
+    reference::ReferenceShaper expectedMixer, expectedPrevious;
+    for (size_t type1 = 0; type1 < shaper::ShaperType::ShaperNUM; ++type1)
+    {
+      for (size_t type2 = 0; type2 < shaper::ShaperType::ShaperNUM; ++type2)
+      {
+        mixer.setTypes(type1, type2);
+        previous.setTypes(type1, type2);
+        expectedMixer.setTypes(type1, type2);
+        expectedPrevious.setTypes(type1, type2);
+        mixer.setShapes(configuration.curve1, configuration.curve2, weight, configuration.compensation);
+        expectedMixer.setShapes(configuration.curve1, configuration.curve2, configuration.weight, configuration.compensation);
+        previous.setShapes(1 - configuration.curve1, configuration.curve2 / 2, 1 - weight, configuration.compensation);
+        expectedPrevious.setShapes(1.0 - configuration.curve1, configuration.curve2 / 2.0, 1.0 - configuration.weight, configuration.compensation);
+
+        for (size_t s = 0; s < signalNUM; ++s)
+        {
+          const auto samples = makeSignal(static_cast<Signal>(s));
+          std::vector<FloatType> input(samples.begin(), samples.end()), output(input.size()), expected(input.size());
+          Result plain, ramp;
+          for (size_t start = 0; start < input.size(); start += kernelBlockSize)
+          {
+            const auto length = std::min(kernelBlockSize, input.size() - start);
+            mixer.process(input.data() + start, output.data() + start, length, FloatType(0.6), FloatType(1));
+            expectedMixer.process(input.data() + start, expected.data() + start, length, 0.6, 1.0);
+            for (auto i = start; i < start + length; ++i)
+              plain.add(output[i], expected[i], i);
+
+            mixer.processRamp(previous, input.data() + start, output.data() + start, length, FloatType(1), FloatType(0.5));
+            expectedMixer.processRamp(expectedPrevious, input.data() + start, expected.data() + start, length, 1.0, 0.5);
+            for (auto i = start; i < start + length; ++i)
+              ramp.add(output[i], expected[i], i);
+          }
+          INFO("styles " << type1 << " / " << type2 << ", " << signalNames[s]);
+          INFO("process: max error " << plain.maxError << " at " << plain.position);
+          INFO("processRamp: max error " << ramp.maxError << " at " << ramp.position);
+          CHECK(plain.maxError < tolerance);
+          CHECK(ramp.maxError < tolerance);
+        }
+      }
+    }
+  }
+
+  struct Configuration
+  {
+    const char* name;
+    std::vector<std::pair<juce::String, float>> parameters;
+    bool doublePrecision;
+    // the renders are stored as 32-bit float, so no tolerance can go below the float resolution
+    double tolerance;
+  };
+
+  juce::File getGoldenFile(const Configuration& configuration, Signal signal)
+  {
+    return juce::File(ZL_GOLDEN_DIR).getChildFile(juce::String(configuration.name) + "_" + signalNames[signal] + ".wav");
+  }
+
+  // the left channel carries the signal, the right one a scaled and inverted copy, so that mid and side both move
+  template <typename FloatType>
+  juce::AudioBuffer<float> render(const Configuration& configuration, const std::vector<double>& samples)
+  {
+    constexpr int blockSize = 256;
+    zlrender::RenderSettings settings;
+    settings.parameters = configuration.parameters;
+    settings.blockSize = blockSize;
+    settings.doublePrecision = std::is_same_v<FloatType, double>;
+    ZLInflatorAudioProcessor processor;
+    REQUIRE(zlrender::prepareProcessor(processor, settings, 2, sampleRate).isEmpty());
+
+    juce::AudioBuffer<FloatType> buffer(2, blockSize);
+    juce::AudioBuffer<float> output(2, numSamples);
+    juce::MidiBuffer midi;
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+      for (int i = 0; i < blockSize; ++i)
+      {
+        const auto sample = samples[static_cast<size_t>(start + i)];
+        buffer.setSample(0, i, static_cast<FloatType>(sample));
+        buffer.setSample(1, i, static_cast<FloatType>(-0.7 * sample));
+      }
+      processor.processBlock(buffer, midi);
+      for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+          output.setSample(ch, start + i, static_cast<float>(buffer.getSample(ch, i)));
+    }
+    return output;
+  }
+
+  void writeGolden(const juce::File& file, const juce::AudioBuffer<float>& buffer)
+  {
+    REQUIRE(file.getParentDirectory().createDirectory());
+    file.deleteFile();
+    const std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(
+        file.createOutputStream().release(), sampleRate, static_cast<unsigned int>(buffer.getNumChannels()), 32, {}, 0));
+    REQUIRE(writer != nullptr);
+    REQUIRE(writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples()));
+  }
+
+  juce::AudioBuffer<float> readGolden(const juce::File& file)
+  {
+    const std::unique_ptr<juce::AudioFormatReader> reader(juce::WavAudioFormat().createReaderFor(
+        file.createInputStream().release(), true));
+    REQUIRE(reader != nullptr);
+    juce::AudioBuffer<float> buffer(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+    reader->read(&buffer, 0, buffer.getNumSamples(), 0, true, true);
+    return buffer;
+  }
+}
+
+TEST_CASE("Optimized shaper kernels match the scalar reference kernel", "[golden]")
+{
+  const std::array<KernelConfiguration, 4> configurations{{{0.25f, 0.25f, 0.5f, false, 1e-6, 1e-12},
+                                                           {0.f, 1.f, 0.f, false, 1e-6, 1e-12},
+                                                           {1.f, 0.f, 1.f, true, 1e-6, 1e-12},
+                                                           {0.7f, 0.35f, 0.8f, true, 1e-6, 1e-12}}};
+  for (const auto& configuration : configurations)
+  {
+    INFO("curves " << configuration.curve1 << " / " << configuration.curve2 << ", weight " << configuration.weight
+                   << (configuration.compensation ? ", compensated" : ""));
+    checkKernels<float>(configuration);
+    checkKernels<double>(configuration);
+  }
+}
+
+TEST_CASE("The shaper lookup table matches the scalar reference kernel", "[golden]")
+{
+  shaper::ShaperMixer<float> mixer;
+  shaper::ShaperTable<float> table;
+  reference::ReferenceShaper expectedMixer;
+  for (size_t type1 = 0; type1 < shaper::ShaperType::ShaperNUM; ++type1)
+  {
+    for (size_t type2 = 0; type2 < shaper::ShaperType::ShaperNUM; ++type2)
+    {
+      mixer.setTypes(type1, type2);
+      expectedMixer.setTypes(type1, type2);
+      mixer.setShapes(0.6f, 0.1f, 0.3f, true);
+      expectedMixer.setShapes(0.6, 0.1, 0.3, true);
+      table.build(mixer);
+      for (size_t s = 0; s < signalNUM; ++s)
+      {
+        const auto samples = makeSignal(static_cast<Signal>(s));
+        std::vector<float> input(samples.begin(), samples.end()), output(input.size()), expected(input.size());
+        table.process(input.data(), output.data(), input.size(), 1.f, 1.f);
+        expectedMixer.process(input.data(), expected.data(), input.size(), 1.0, 1.0);
+        Result result;
+        for (size_t i = 0; i < input.size(); ++i)
+          result.add(output[i], expected[i], i);
+        INFO("styles " << type1 << " / " << type2 << ", " << signalNames[s]);
+        INFO("max error " << result.maxError << " at " << result.position);
+        CHECK(result.maxError < 2e-6);
+      }
+    }
+  }
+}
+
+TEST_CASE("The processor output matches the stored golden renders", "[golden]")
+{
+  const std::vector<Configuration> configurations{
+      {"default", {}, false, 1e-5},
+      {"styles", {{zldsp::style1::ID, 4.f}, {zldsp::style2::ID, 2.f}, {zldsp::curve1::ID, 80.f}, {zldsp::curve2::ID, 10.f}, {zldsp::weight::ID, 35.f}}, false, 1e-5},
+      {"gain_wet", {{zldsp::inputGain::ID, 6.f}, {zldsp::outputGain::ID, -3.f}, {zldsp::wet::ID, 60.f}}, false, 1e-5},
+      {"band_split", {{zldsp::bandSplit::ID, 1.f}, {zldsp::lowSplit::ID, 300.f}, {zldsp::highSplit::ID, 4000.f}}, false, 2e-5},
+      {"mid_side", {{zldsp::midSide::ID, 1.f}, {zldsp::sideWet::ID, 40.f}, {zldsp::sideCurve1::ID, 90.f}}, false, 1e-5},
+      {"oversample_2x_iir", {{zldsp::overSample::ID, 1.f}, {zldsp::overSampleQuality::ID, 0.f}, {zldsp::bandSplit::ID, 1.f}}, false, 1e-4},
+      {"oversample_2x_fir", {{zldsp::overSample::ID, 1.f}, {zldsp::overSampleQuality::ID, 1.f}, {zldsp::bandSplit::ID, 1.f}}, false, 1e-4},
+      {"oversample_4x_iir", {{zldsp::overSample::ID, 2.f}, {zldsp::overSampleQuality::ID, 0.f}, {zldsp::bandSplit::ID, 1.f}}, false, 1e-4},
+      {"oversample_4x_fir", {{zldsp::overSample::ID, 2.f}, {zldsp::overSampleQuality::ID, 1.f}, {zldsp::bandSplit::ID, 1.f}}, false, 1e-4},
+      {"double", {{zldsp::bandSplit::ID, 1.f}, {zldsp::overSample::ID, 1.f}}, true, 1e-6}};
+  const auto update = juce::SystemStats::getEnvironmentVariable("ZL_UPDATE_GOLDEN", {}).getIntValue() != 0;
+  juce::StringArray recorded;
+
+  for (const auto& configuration : configurations)
+  {
+    for (size_t s = 0; s < signalNUM; ++s)
+    {
+      const auto signal = static_cast<Signal>(s);
+      const auto samples = makeSignal(signal);
+      const auto output = configuration.doublePrecision ? render<double>(configuration, samples)
+                                                        : render<float>(configuration, samples);
+      const auto file = getGoldenFile(configuration, signal);
+      INFO(file.getFileName());
+      if (update)
+      {
+        writeGolden(file, output);
+        recorded.add(file.getFileName());
+        continue;
+      }
+      if (!file.existsAsFile())
+      {
+        FAIL_CHECK("no golden render, record it with ZL_UPDATE_GOLDEN=1");
+        continue;
+      }
+
+      const auto golden = readGolden(file);
+      REQUIRE(golden.getNumChannels() == output.getNumChannels());
+      REQUIRE(golden.getNumSamples() == output.getNumSamples());
+      Result result;
+      for (int ch = 0; ch < output.getNumChannels(); ++ch)
+        for (int i = 0; i < output.getNumSamples(); ++i)
+          result.add(output.getSample(ch, i), golden.getSample(ch, i), static_cast<size_t>(i));
+      INFO("max error " << result.maxError << " at " << result.position);
+      CHECK(result.maxError < configuration.tolerance);
+    }
+  }
+
+  if (!recorded.isEmpty())
+    SKIP("recorded " << recorded.joinIntoString(", ") << " in " << ZL_GOLDEN_DIR);
+}
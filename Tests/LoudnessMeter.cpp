@@ -0,0 +1,58 @@
+#include <DSP/LoudnessMeter.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace
+{
+  struct SineSource
+  {
+    double sampleRate;
+    long position = 0;
+
+    void render(zldsp::LoudnessMeter<float>& meter, double gain, double seconds)
+    {
+      std::vector<float> data(512);
+      float* channels[] = {data.data()};
+      for (long block = 0; block < static_cast<long>(seconds * sampleRate) / 512; ++block)
+      {
+        for (auto& x : data)
+          x = static_cast<float>(gain * std::sin(juce::MathConstants<double>::twoPi * 997.0 * static_cast<double>(position++) / sampleRate));
+        meter.process(juce::dsp::AudioBlock<float>(channels, 1, data.size()));
+      }
+    }
+  };
+}
+
+TEST_CASE("LoudnessMeter reads a full scale 997 Hz sine as -3.01 LUFS", "[loudness]")
+{
+  for (const auto sampleRate : {44100.0, 48000.0, 96000.0})
+  {
+    zldsp::LoudnessMeter<float> meter;
+    meter.prepare({sampleRate, 512, 1});
+    SineSource source{sampleRate};
+    source.render(meter, 1.0, 5.0);
+
+    CHECK_THAT(meter.getMomentary(), Catch::Matchers::WithinAbs(-3.01, 0.05));
+    CHECK_THAT(meter.getShortTerm(), Catch::Matchers::WithinAbs(-3.01, 0.05));
+    CHECK_THAT(meter.getIntegrated(), Catch::Matchers::WithinAbs(-3.01, 0.05));
+    CHECK_THAT(meter.getLoudnessRange(), Catch::Matchers::WithinAbs(0.0, 0.2));
+  }
+}
+
+TEST_CASE("LoudnessMeter gates silence out of the integrated loudness", "[loudness]")
+{
+  zldsp::LoudnessMeter<float> meter;
+  meter.prepare({48000.0, 512, 1});
+  SineSource source{48000.0};
+
+  // 10 s at -23 LUFS and 10 s at -33 LUFS average to -25.6 LUFS, the silence after them is gated
+  source.render(meter, 0.1, 10.0);
+  source.render(meter, 0.1 * std::pow(10.0, -0.5), 10.0);
+  source.render(meter, 0.0, 10.0);
+  CHECK_THAT(meter.getIntegrated(), Catch::Matchers::WithinAbs(-23.01 + 10.0 * std::log10(0.55), 0.1));
+  CHECK(meter.getMomentary() <= -70.f);
+
+  meter.requestReset();
+  source.render(meter, 0.1, 1.0);
+  CHECK_THAT(meter.getIntegrated(), Catch::Matchers::WithinAbs(-23.01, 0.1));
+}
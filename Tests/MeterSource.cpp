@@ -0,0 +1,81 @@
+#include <DSP/MeterSource.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+namespace
+{
+  template<typename T>
+  void process(MeterSource<float>& meter, std::vector<T>& data)
+  {
+    T* channels[] = {data.data()};
+    juce::dsp::AudioBlock<T> block(channels, 1, data.size());
+    meter.process(juce::dsp::ProcessContextReplacing<T>(block));
+  }
+}
+
+TEST_CASE("MeterSource measures the absolute peak and the RMS in one pass", "[meter]")
+{
+  MeterSource<float> meter;
+  meter.prepare({48000.0, 512, 1});
+
+  // an odd length and a negative peak off the SIMD lanes
+  std::vector<double> data(301, 0.1);
+  data[7] = -0.5;
+  process(meter, data);
+
+  const auto& display = meter.updateDisplay();
+  REQUIRE(display.getPeakMax().size() == 1);
+  CHECK_THAT(display.getPeakMax()[0], Catch::Matchers::WithinAbs(juce::Decibels::gainToDecibels(0.5), 1e-4));
+  const auto rms = std::sqrt((300 * 0.01 + 0.25) / 301);
+  CHECK_THAT(display.getRMS()[0], Catch::Matchers::WithinAbs(juce::Decibels::gainToDecibels(rms), 1e-4));
+}
+
+TEST_CASE("MeterSource keeps the RMS of long float blocks exact", "[meter]")
+{
+  constexpr size_t numSamples = 1 << 20;
+  MeterSource<float> meter;
+  meter.prepare({48000.0, static_cast<juce::uint32>(numSamples), 1});
+
+  // summed in float, the lanes would reach 1e4 and drop most of every 0.09 they add
+  std::vector<float> data(numSamples, 0.3f);
+  process(meter, data);
+
+  CHECK_THAT(meter.updateDisplay().getRMS()[0], Catch::Matchers::WithinAbs(juce::Decibels::gainToDecibels(0.3f), 1e-4));
+}
+
+TEST_CASE("MeterSource finds the true peak between the samples", "[meter]")
+{
+  MeterSource<float> meter;
+  meter.prepare({48000.0, 512, 1});
+  meter.setTruePeak(true);
+
+  // a sine at a quarter of the sample rate, sampled at 45 degrees, peaks 3 dB above its samples
+  std::vector<float> data(512);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<float>(std::sin(juce::MathConstants<double>::halfPi * static_cast<double>(i) + juce::MathConstants<double>::pi / 4));
+  process(meter, data);
+
+  CHECK_THAT(meter.updateDisplay().getPeakMax()[0], Catch::Matchers::WithinAbs(0.0, 0.5));
+}
+
+TEST_CASE("MeterSource keeps every block while the GUI is not reading", "[meter]")
+{
+  MeterSource<float> meter;
+  meter.prepare({48000.0, 16, 1});
+
+  // far more blocks than the FIFO holds, the loudest one in the middle
+  std::vector<float> data(16);
+  for (int block = 0; block < 1000; ++block)
+  {
+    std::fill(data.begin(), data.end(), block == 500 ? 0.5f : 0.01f);
+    process(meter, data);
+  }
+
+  // the blocks that did not fit are merged into one frame, which is sent once the GUI has made room
+  meter.updateDisplay();
+  std::fill(data.begin(), data.end(), 0.01f);
+  process(meter, data);
+  const auto& display = meter.updateDisplay();
+  CHECK_THAT(display.getPeak()[0], Catch::Matchers::WithinAbs(juce::Decibels::gainToDecibels(0.5f), 1e-4));
+  CHECK_THAT(display.getPeakMax()[0], Catch::Matchers::WithinAbs(juce::Decibels::gainToDecibels(0.5f), 1e-4));
+}
@@ -0,0 +1,84 @@
+#include <OfflineRenderer.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+  juce::AudioBuffer<float> readFile(const juce::File& file)
+  {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    const std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    REQUIRE(reader != nullptr);
+    juce::AudioBuffer<float> buffer(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+    reader->read(&buffer, 0, buffer.getNumSamples(), 0, true, true);
+    return buffer;
+  }
+}
+
+TEST_CASE("A file rendered in parallel chunks matches the single-threaded render", "[render]")
+{
+  constexpr double sampleRate = 48000.0;
+  constexpr int numSamples = 6 * 48000;
+  const juce::TemporaryFile input(".wav"), single(".wav"), chunked(".wav");
+
+  // a low sine with noise on top, through the crossover and the oversampler
+  {
+    juce::AudioBuffer<float> signal(2, numSamples);
+    juce::Random random(42);
+    for (int ch = 0; ch < 2; ++ch)
+      for (int i = 0; i < numSamples; ++i)
+        signal.setSample(ch, i, 0.6f * std::sin(0.01f * static_cast<float>(i + 300 * ch)) + 0.3f * (random.nextFloat() - 0.5f));
+    const std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(
+        input.getFile().createOutputStream().release(), sampleRate, 2, 32, {}, 0));
+    REQUIRE(writer != nullptr);
+    writer->writeFromAudioSampleBuffer(signal, 0, numSamples);
+  }
+
+  zlrender::RenderSettings settings;
+  settings.parameters = {{zldsp::bandSplit::ID, 1.f}, {zldsp::overSample::ID, 2.f}, {zldsp::curve1::ID, 80.f}};
+  juce::TimeSliceThread writerThread("writer");
+  writerThread.startThread();
+  REQUIRE(zlrender::renderFile(input.getFile(), single.getFile(), settings, writerThread).ok);
+
+  // chunks that do not line up with the blocks, with a shorter pre-roll than the default
+  settings.chunkSeconds = 0.7;
+  settings.preRollSeconds = 0.5;
+  juce::ThreadPool pool(4);
+  REQUIRE(zlrender::renderFile(input.getFile(), chunked.getFile(), settings, writerThread, &pool).ok);
+  writerThread.stopThread(1000);
+
+  const auto expected = readFile(single.getFile());
+  const auto actual = readFile(chunked.getFile());
+  REQUIRE(actual.getNumSamples() == numSamples);
+  REQUIRE(expected.getNumSamples() == numSamples);
+  float maxError = 0.f;
+  for (int ch = 0; ch < 2; ++ch)
+    for (int i = 0; i < numSamples; ++i)
+      maxError = juce::jmax(maxError, std::abs(actual.getSample(ch, i) - expected.getSample(ch, i)));
+  INFO("max error " << maxError);
+  CHECK(maxError < 1e-5f);
+}
+
+TEST_CASE("A render never replaces its own input", "[render]")
+{
+  const juce::TemporaryFile input(".wav");
+  {
+    juce::AudioBuffer<float> signal(2, 4800);
+    signal.clear();
+    signal.setSample(0, 100, 0.5f);
+    const std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(
+        input.getFile().createOutputStream().release(), 48000.0, 2, 32, {}, 0));
+    REQUIRE(writer != nullptr);
+    writer->writeFromAudioSampleBuffer(signal, 0, signal.getNumSamples());
+  }
+  const auto sizeBefore = input.getFile().getSize();
+
+  juce::TimeSliceThread writerThread("writer");
+  writerThread.startThread();
+  const auto result = zlrender::renderFile(input.getFile(), input.getFile(), {}, writerThread);
+  writerThread.stopThread(1000);
+
+  CHECK_FALSE(result.ok);
+  CHECK(input.getFile().getSize() == sizeBefore);
+  CHECK(readFile(input.getFile()).getSample(0, 100) == 0.5f);
+}
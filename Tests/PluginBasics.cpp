@@ -8,12 +8,12 @@ TEST_CASE("one is equal to one", "[dummy]")
 }
 
 // https://github.com/McMartin/FRUT/issues/490#issuecomment-663544272
-PluginProcessor testPlugin;
+ZLInflatorAudioProcessor testPlugin;
 
 TEST_CASE("Plugin instance name", "[name]")
 {
   CHECK_THAT(testPlugin.getName().toStdString(),
-             Catch::Matchers::Equals("Pamplejuce"));
+             Catch::Matchers::Equals("ZL Inflator"));
 }
 
 #ifdef PAMPLEJUCE_IPP
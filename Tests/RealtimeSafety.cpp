@@ -0,0 +1,172 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <string>
+
+#if ZL_REALTIME_AUDIT
+
+// processBlock opens its own audit section and the hooks live in DSP/RealtimeAudit.cpp,
+// so the tests only need to clear and read the audit.
+namespace
+{
+  struct RealtimeScope
+  {
+    RealtimeScope() { zldsp::RealtimeAudit::clear(); }
+  };
+
+  int getNumViolations() { return zldsp::RealtimeAudit::getNumViolations(); }
+
+  std::string getReport() { return zldsp::RealtimeAudit::getReport().toStdString(); }
+
+  std::vector<int>* volatile sink = nullptr;
+}
+
+TEST_CASE("realtime audit reports heap calls and locks with a backtrace", "[realtime]")
+{
+  std::mutex mutex;
+  {
+    const RealtimeScope scope;
+    ZL_REALTIME_AUDIT_SECTION;
+    sink = new std::vector<int>(16);
+    const std::lock_guard<std::mutex> guard(mutex);
+  }
+  delete sink;
+
+  const auto violations = zldsp::RealtimeAudit::getViolations();
+  REQUIRE(!violations.empty());
+  CHECK(violations.front().kind == zldsp::RealtimeAudit::heap);
+  CHECK(violations.front().backtrace.isNotEmpty());
+  #if defined(__GLIBC__)
+  CHECK(std::any_of(violations.begin(), violations.end(), [](const auto& v) { return v.kind == zldsp::RealtimeAudit::lock; }));
+  #endif
+}
+
+#else
+
+  #if JUCE_LINUX
+    #include <dlfcn.h>
+    #include <pthread.h>
+  #endif
+
+// Counts heap and mutex calls made by the thread inside a RealtimeScope.
+// The hooks replace the global operator new / delete of the test executable,
+// and on Linux interpose pthread_mutex_lock as well.
+// Configure with ZL_REALTIME_AUDIT=ON for the full audit with backtraces.
+namespace
+{
+  thread_local bool insideScope = false;
+  std::atomic<int> heapCalls{0}, lockCalls{0};
+
+  struct RealtimeScope
+  {
+    RealtimeScope()
+    {
+      heapCalls = 0;
+      lockCalls = 0;
+      insideScope = true;
+    }
+
+    ~RealtimeScope() { insideScope = false; }
+  };
+
+  int getNumViolations() { return heapCalls + lockCalls; }
+
+  std::string getReport()
+  {
+    return std::to_string(heapCalls) + " heap calls, " + std::to_string(lockCalls) + " locks";
+  }
+}
+
+void* operator new(std::size_t size)
+{
+  if (insideScope)
+    ++heapCalls;
+  if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  if (ptr != nullptr && insideScope)
+    ++heapCalls;
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+  #if JUCE_LINUX
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+  using LockFunction = int (*)(pthread_mutex_t*);
+  static const auto next = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+  if (insideScope)
+    ++lockCalls;
+  return next(mutex);
+}
+  #endif
+
+#endif
+
+TEST_CASE("processBlock neither allocates nor locks after prepareToPlay", "[realtime]")
+{
+  constexpr int numSamples = 512;
+  ZLInflatorAudioProcessor processor;
+  processor.prepareToPlay(48000.0, numSamples);
+
+  juce::AudioBuffer<float> buffer(2, numSamples);
+  juce::MidiBuffer midi;
+
+  auto setParameter = [&] (const char* ID, float value) {
+    auto* parameter = processor.parameters.getParameter(ID);
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+  };
+
+  auto render = [&] (int numBlocks) {
+    for (int block = 0; block < numBlocks; ++block)
+    {
+      for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        for (int i = 0; i < numSamples; ++i)
+          buffer.setSample(ch, i, 0.8f * std::sin(0.01f * static_cast<float>(block * numSamples + i)));
+
+      {
+        const RealtimeScope scope;
+        processor.processBlock(buffer, midi);
+      }
+      INFO(getReport());
+      CHECK(getNumViolations() == 0);
+    }
+  };
+
+  SECTION("default parameters")
+  {
+    render(8);
+  }
+
+  SECTION("band split with oversampling")
+  {
+    setParameter(zldsp::bandSplit::ID, 1.f);
+    setParameter(zldsp::overSample::ID, 2.f);
+    render(8);
+  }
+
+  SECTION("parameters ramping between blocks")
+  {
+    setParameter(zldsp::bandSplit::ID, 1.f);
+    render(2);
+    setParameter(zldsp::curve1::ID, 80.f);
+    setParameter(zldsp::weight::ID, 10.f);
+    setParameter(zldsp::wet::ID, 40.f);
+    setParameter(zldsp::lowSplit::ID, 800.f);
+    setParameter(zldsp::style2::ID, 4.f);
+    render(8);
+  }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <DSP/ShaperFunctions.h>
+
+#include <array>
+#include <cmath>
+
+namespace reference
+{
+  // The scalar shaper as it was before the fused and SIMD kernels, written out sample by sample in double.
+  // It is frozen on purpose: optimized kernels are checked against it, so do not "optimize" it.
+  class ReferenceShaper
+  {
+  public:
+    void setTypes(size_t newType1, size_t newType2)
+    {
+      type1 = newType1;
+      type2 = newType2;
+    }
+
+    void setShapes(double newCurve1, double newCurve2, double newWeight, bool newCompensation)
+    {
+      curve1 = newCurve1;
+      curve2 = newCurve2;
+      weight = newWeight;
+      compensation = newCompensation;
+    }
+
+    // the mixed curve on [0, 1]
+    double operator()(double x) const
+    {
+      return shape(type1, curve1, x) * (1.0 - weight) + shape(type2, curve2, x) * weight;
+    }
+
+    // out = sgn(x) * mix(min(|x|, 1)) * wet + x * (1 - wet), wet moves linearly across the block
+    template <typename FloatType>
+    void process(const FloatType* in, FloatType* out, size_t numSamples, double wetStart, double wetEnd) const
+    {
+      processRamp(*this, in, out, numSamples, wetStart, wetEnd, 1.0, 1.0);
+    }
+
+    // same as process, the curve moves linearly from the curve of from between rampStart and rampEnd
+    template <typename FloatType>
+    void processRamp(const ReferenceShaper& from, const FloatType* in, FloatType* out, size_t numSamples,
+        double wetStart, double wetEnd, double rampStart = 0.0, double rampEnd = 1.0) const
+    {
+      for (size_t i = 0; i < numSamples; ++i)
+      {
+        const auto u = static_cast<double>(i) / static_cast<double>(numSamples);
+        const auto t = rampStart + (rampEnd - rampStart) * u;
+        const auto wet = wetStart + (wetEnd - wetStart) * u;
+        const auto x = static_cast<double>(in[i]);
+        const auto magnitude = std::min(1.0, std::abs(x));
+        const auto y0 = from(magnitude);
+        const auto y = y0 + ((*this)(magnitude) - y0) * t;
+        out[i] = static_cast<FloatType>(x + ((x > 0 ? y : -y) - x) * wet);
+      }
+    }
+
+  private:
+    size_t type1 = static_cast<size_t>(zldsp::style1::defaultI), type2 = static_cast<size_t>(zldsp::style2::defaultI);
+    double curve1 = 0.25, curve2 = 0.25, weight = 0.5;
+    bool compensation = false;
+
+    double shape(size_t type, double curve, double x) const
+    {
+      switch (type)
+      {
+        case shaper::ShaperType::identity:
+          return x;
+        case shaper::ShaperType::quadratic:
+          return x * (2.0 - x) * (compensation ? 1.0 / 1.7619606880293588 : 1.0);
+        case shaper::ShaperType::cubic:
+          return x * (1.0 + x - x * x) * (compensation ? 1.0 / 1.0982883051371357 : 1.0);
+        case shaper::ShaperType::quartic:
+        {
+          const auto c = -6.0 + 6.0 * curve;
+          const auto scale = compensation ? 1.0 / (0.029832404608718992 * c + 1.2211563052435235) : 1.0;
+          return (x + (6.0 + c) / 2.0 * x * x + (-5.0 - c) * x * x * x + (4.0 + c) / 2.0 * x * x * x * x) * scale;
+        }
+        case shaper::ShaperType::sin:
+        {
+          const auto trueCurve = (std::pow(curve, 0.427) * 0.999 + 0.001) * juce::MathConstants<double>::halfPi;
+          const auto scale = compensation ? 1.0 / (0.48339138157922157 * curve + 0.9999698009251106) : 1.0;
+          return std::sin(x * trueCurve) / std::sin(trueCurve) * scale;
+        }
+        default:
+          return x;
+      }
+    }
+  };
+}
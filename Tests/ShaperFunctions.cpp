@@ -0,0 +1,84 @@
+#include <DSP/ShaperFunctions.h>
+#include <DSP/ShaperTable.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("fastSin matches std::sin", "[shaper]")
+{
+  constexpr int numPoints = 100000;
+
+  SECTION("double")
+  {
+    double maxRelError = 0.0;
+    for (int i = 1; i <= numPoints; ++i)
+    {
+      const auto x = juce::MathConstants<double>::halfPi * static_cast<double>(i) / numPoints;
+      maxRelError = std::max(maxRelError, std::abs(shaper::fastSin<double>(x) / std::sin(x) - 1.0));
+    }
+    CHECK(maxRelError < 1e-15);
+  }
+
+  SECTION("float")
+  {
+    double maxAbsError = 0.0;
+    for (int i = 0; i <= numPoints; ++i)
+    {
+      const auto x = juce::MathConstants<float>::halfPi * static_cast<float>(i) / numPoints;
+      maxAbsError = std::max(maxAbsError, static_cast<double>(std::abs(shaper::fastSin<float>(x) - std::sin(x))));
+    }
+    CHECK(maxAbsError < 2e-7);
+  }
+}
+
+TEST_CASE("SinMOD style stays anchored at 0 and 1", "[shaper]")
+{
+  shaper::ShaperMixer<float> mixer;
+  mixer.setTypes(shaper::ShaperType::sin, shaper::ShaperType::sin);
+  for (auto curve : {0.f, 0.25f, 0.5f, 1.f})
+  {
+    mixer.setShapes(curve, curve, 0.5f, false);
+    CHECK_THAT(mixer(0.f), Catch::Matchers::WithinAbs(0.0, 1e-6));
+    CHECK_THAT(mixer(1.f), Catch::Matchers::WithinAbs(1.0, 1e-6));
+  }
+}
+
+TEST_CASE("ShaperTable follows the analytic kernels", "[shaper]")
+{
+  shaper::ShaperMixer<float> mixer;
+  shaper::ShaperTable<float> table;
+  std::array<float, 2001> input{}, expected{}, actual{};
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = (static_cast<float>(i) - 1000.f) / 900.f;
+
+  for (size_t type1 = 0; type1 < shaper::ShaperType::ShaperNUM; ++type1)
+  {
+    for (size_t type2 = 0; type2 < shaper::ShaperType::ShaperNUM; ++type2)
+    {
+      mixer.setTypes(type1, type2);
+      mixer.setShapes(0.3f, 0.8f, 0.4f, true);
+      table.build(mixer);
+      mixer.process(input.data(), expected.data(), input.size(), 0.9f, 0.9f);
+      table.process(input.data(), actual.data(), input.size(), 0.9f, 0.9f);
+      for (size_t i = 0; i < input.size(); ++i)
+        CHECK_THAT(actual[i], Catch::Matchers::WithinAbs(expected[i], 1e-6));
+    }
+  }
+}
+
+TEST_CASE("ShaperMixer ramps move from the previous curve and wet", "[shaper]")
+{
+  shaper::ShaperMixer<float> from, to;
+  from.setShapes(0.1f, 0.2f, 0.3f, false);
+  to.setShapes(0.9f, 0.7f, 0.6f, false);
+
+  constexpr size_t numSamples = 256;
+  std::vector<float> input(numSamples, 0.5f), ramp(numSamples), start(numSamples), end(numSamples);
+  to.processRamp(from, input.data(), ramp.data(), numSamples, 0.2f, 1.f);
+  from.process(input.data(), start.data(), numSamples, 0.2f, 0.2f);
+  to.process(input.data(), end.data(), numSamples, 1.f, 1.f);
+
+  CHECK_THAT(ramp.front(), Catch::Matchers::WithinAbs(start.front(), 1e-6));
+  CHECK_THAT(ramp.back(), Catch::Matchers::WithinAbs(end.back(), 2e-2));
+  for (size_t i = 1; i < numSamples; ++i)
+    CHECK(std::abs(ramp[i] - ramp[i - 1]) < 1e-2f);
+}
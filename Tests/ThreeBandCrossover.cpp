@@ -0,0 +1,47 @@
+#include <DSP/ThreeBandCrossover.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+TEST_CASE("ThreeBandCrossover matches the cascaded LinkwitzRileyFilter network", "[crossover]")
+{
+  constexpr double sampleRate = 96000.0;
+  constexpr size_t numSamples = 512;
+  const juce::dsp::ProcessSpec spec{sampleRate, static_cast<juce::uint32>(numSamples), 1};
+
+  zldsp::ThreeBandCrossover<double> crossover;
+  crossover.prepare(spec);
+  crossover.setCutoffFrequencies(240.0, 2400.0);
+
+  using Type = juce::dsp::LinkwitzRileyFilterType;
+  std::array<juce::dsp::LinkwitzRileyFilter<double>, 5> filters;
+  const std::array<std::pair<Type, double>, 5> settings{{{Type::lowpass, 240.0},
+                                                         {Type::allpass, 2400.0},
+                                                         {Type::highpass, 240.0},
+                                                         {Type::lowpass, 2400.0},
+                                                         {Type::highpass, 2400.0}}};
+  for (size_t i = 0; i < filters.size(); ++i)
+  {
+    filters[i].prepare(spec);
+    filters[i].setType(settings[i].first);
+    filters[i].setCutoffFrequency(settings[i].second);
+  }
+
+  std::vector<double> input(numSamples), low(numSamples), mid(numSamples), high(numSamples);
+  for (int block = 0; block < 8; ++block)
+  {
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+      const auto n = static_cast<double>(static_cast<size_t>(block) * numSamples + i);
+      input[i] = std::sin(0.37 * n) + 0.5 * std::sin(0.013 * n);
+    }
+    crossover.process(0, input.data(), low.data(), mid.data(), high.data(), numSamples);
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+      const auto rest = filters[2].processSample(0, input[i]);
+      CHECK_THAT(low[i], Catch::Matchers::WithinAbs(filters[1].processSample(0, filters[0].processSample(0, input[i])), 1e-12));
+      CHECK_THAT(mid[i], Catch::Matchers::WithinAbs(filters[3].processSample(0, rest), 1e-12));
+      CHECK_THAT(high[i], Catch::Matchers::WithinAbs(filters[4].processSample(0, rest), 1e-12));
+    }
+  }
+}
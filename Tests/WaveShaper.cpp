@@ -0,0 +1,365 @@
+#include <PluginProcessor.h>
+#include <catch2/catch_test_macros.hpp>
+
+namespace
+{
+  void setParameter(ZLInflatorAudioProcessor& processor, const char* ID, float value)
+  {
+    auto* parameter = processor.parameters.getParameter(ID);
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+  }
+
+  void render(ZLInflatorAudioProcessor& processor, int numBlocks)
+  {
+    juce::AudioBuffer<float> buffer(2, 512);
+    juce::MidiBuffer midi;
+    for (int block = 0; block < numBlocks; ++block)
+    {
+      for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+          buffer.setSample(ch, i, 0.5f * std::sin(0.02f * static_cast<float>(block * buffer.getNumSamples() + i)));
+      processor.processBlock(buffer, midi);
+    }
+  }
+}
+
+TEST_CASE("Only the selected oversampler is allocated", "[oversampling]")
+{
+  ZLInflatorAudioProcessor processor;
+  processor.prepareToPlay(48000.0, 512);
+  render(processor, 1);
+  const auto baseMemory = processor.getMemoryUsage();
+
+  setParameter(processor, zldsp::overSample::ID, 4.f);
+  render(processor, 2);
+  const auto memory16x = processor.getMemoryUsage();
+  CHECK(memory16x > baseMemory + 2 * 512 * 16 * sizeof(float));
+
+  // once the audio thread has moved back to 1x, the 16x oversampler is freed
+  setParameter(processor, zldsp::overSample::ID, 0.f);
+  render(processor, 2);
+  CHECK(processor.getMemoryUsage() == baseMemory);
+}
+
+TEST_CASE("Constant latency keeps the reported latency and fades between oversamplers", "[oversampling]")
+{
+  ZLInflatorAudioProcessor processor;
+  setParameter(processor, zldsp::constantLatency::ID, 1.f);
+  processor.prepareToPlay(48000.0, 512);
+  const auto latency = processor.getLatencySamples();
+  CHECK(latency > 0);
+
+  juce::AudioBuffer<float> buffer(2, 512);
+  juce::MidiBuffer midi;
+  float previous = 0.f;
+  for (int block = 0; block < 16; ++block)
+  {
+    if (block == 4)
+      setParameter(processor, zldsp::overSample::ID, 3.f);
+    if (block == 10)
+      setParameter(processor, zldsp::overSample::ID, 1.f);
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+      for (int i = 0; i < buffer.getNumSamples(); ++i)
+        buffer.setSample(ch, i, 0.5f * std::sin(0.02f * static_cast<float>(block * buffer.getNumSamples() + i)));
+    processor.processBlock(buffer, midi);
+    CHECK(processor.getLatencySamples() == latency);
+
+    // a slow sine stays smooth across the switches
+    float maxStep = 0.f;
+    for (int i = 0; i < buffer.getNumSamples(); ++i)
+    {
+      const auto sample = buffer.getSample(0, i);
+      maxStep = std::max(maxStep, std::abs(sample - previous));
+      previous = sample;
+    }
+    CHECK(maxStep < 0.1f);
+  }
+}
+
+TEST_CASE("Filter quality trades latency for linear phase", "[oversampling]")
+{
+  ZLInflatorAudioProcessor processor;
+  processor.prepareToPlay(48000.0, 512);
+  setParameter(processor, zldsp::overSample::ID, 2.f);
+
+  std::array<int, zldsp::overSampleQuality::qualityNUM> latencies{};
+  for (int quality = 0; quality < zldsp::overSampleQuality::qualityNUM; ++quality)
+  {
+    setParameter(processor, zldsp::overSampleQuality::ID, static_cast<float>(quality));
+    render(processor, 4);
+    latencies[static_cast<size_t>(quality)] = processor.getLatencySamples();
+    CHECK(processor.getOverSamplerLoad() > 0.f);
+  }
+  CHECK(latencies[zldsp::overSampleQuality::iir] < latencies[zldsp::overSampleQuality::eco]);
+  CHECK(latencies[zldsp::overSampleQuality::eco] < latencies[zldsp::overSampleQuality::fir]);
+}
+
+TEST_CASE("Offline renders switch to the render factor with the same latency", "[oversampling]")
+{
+  ZLInflatorAudioProcessor processor;
+  processor.prepareToPlay(48000.0, 512);
+  render(processor, 1);
+  const auto liveMemory = processor.getMemoryUsage();
+  CHECK(processor.getLatencySamples() == 0);
+
+  setParameter(processor, zldsp::renderOverSample::ID, 3.f);
+  render(processor, 1);
+  const auto latency = processor.getLatencySamples();
+  CHECK(latency > 0);
+  CHECK(processor.getMemoryUsage() == liveMemory);
+
+  processor.setNonRealtime(true);
+  render(processor, 2);
+  CHECK(processor.getLatencySamples() == latency);
+  CHECK(processor.getMemoryUsage() > liveMemory + 2 * 512 * 8 * sizeof(float));
+
+  processor.setNonRealtime(false);
+  render(processor, 2);
+  CHECK(processor.getLatencySamples() == latency);
+  CHECK(processor.getMemoryUsage() == liveMemory);
+}
+
+TEST_CASE("The double precision chain matches the float chain", "[precision]")
+{
+  constexpr int numSamples = 512;
+  ZLInflatorAudioProcessor floatProcessor, doubleProcessor;
+  doubleProcessor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+  for (auto* processor : {&floatProcessor, &doubleProcessor})
+  {
+    processor->prepareToPlay(48000.0, numSamples);
+    setParameter(*processor, zldsp::bandSplit::ID, 1.f);
+    setParameter(*processor, zldsp::overSample::ID, 2.f);
+  }
+
+  juce::AudioBuffer<float> floatBuffer(2, numSamples);
+  juce::AudioBuffer<double> doubleBuffer(2, numSamples);
+  juce::MidiBuffer midi;
+  for (int block = 0; block < 8; ++block)
+  {
+    for (int ch = 0; ch < 2; ++ch)
+      for (int i = 0; i < numSamples; ++i)
+      {
+        const auto x = 0.8 * std::sin(0.03 * static_cast<double>(block * numSamples + i));
+        floatBuffer.setSample(ch, i, static_cast<float>(x));
+        doubleBuffer.setSample(ch, i, x);
+      }
+    floatProcessor.processBlock(floatBuffer, midi);
+    doubleProcessor.processBlock(doubleBuffer, midi);
+
+    double maxError = 0.0;
+    for (int ch = 0; ch < 2; ++ch)
+      for (int i = 0; i < numSamples; ++i)
+        maxError = std::max(maxError, std::abs(doubleBuffer.getSample(ch, i) - floatBuffer.getSample(ch, i)));
+    CHECK(maxError < 1e-4);
+  }
+}
+
+TEST_CASE("Channel pairs are shaped in parallel like stereo, and linked channels keep their balance", "[multichannel]")
+{
+  constexpr int numSamples = 512, numChannels = 8;
+  ZLInflatorAudioProcessor stereo, surround;
+  juce::AudioProcessor::BusesLayout layout;
+  layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+  layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+  REQUIRE(surround.setBusesLayout(layout));
+  for (auto* processor : {&stereo, &surround})
+  {
+    processor->prepareToPlay(48000.0, numSamples);
+    // 8 channels at 4x are spread over the worker pool
+    setParameter(*processor, zldsp::overSample::ID, 2.f);
+  }
+
+  juce::AudioBuffer<float> stereoBuffer(2, numSamples), surroundBuffer(numChannels, numSamples);
+  juce::MidiBuffer midi;
+  auto fill = [&](juce::AudioBuffer<float>& buffer, int block, bool scaled) {
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+      for (int i = 0; i < numSamples; ++i)
+      {
+        const auto gain = scaled && ch >= 2 ? 0.5f : 1.f;
+        buffer.setSample(ch, i, gain * 0.9f * std::sin(0.05f * static_cast<float>(block * numSamples + i) + 0.3f * static_cast<float>(ch % 2)));
+      }
+  };
+
+  for (int block = 0; block < 4; ++block)
+  {
+    fill(stereoBuffer, block, false);
+    fill(surroundBuffer, block, false);
+    stereo.processBlock(stereoBuffer, midi);
+    surround.processBlock(surroundBuffer, midi);
+    for (int ch = 0; ch < numChannels; ++ch)
+      for (int i = 0; i < numSamples; ++i)
+        REQUIRE(surroundBuffer.getSample(ch, i) == stereoBuffer.getSample(ch % 2, i));
+  }
+
+  // linked, every channel gets the gain of the loudest one, so half the input gives half the output
+  setParameter(surround, zldsp::channelLink::ID, 1.f);
+  for (int block = 0; block < 4; ++block)
+  {
+    fill(surroundBuffer, block, true);
+    surround.processBlock(surroundBuffer, midi);
+    for (int i = 0; i < numSamples; ++i)
+      CHECK(std::abs(surroundBuffer.getSample(2, i) - 0.5f * surroundBuffer.getSample(0, i)) < 1e-5f);
+  }
+}
+
+TEST_CASE("Mid/side mode shapes mid and side with their own amounts", "[midside]")
+{
+  constexpr int numSamples = 512;
+  ZLInflatorAudioProcessor stereo, midSide;
+  for (auto* processor : {&stereo, &midSide})
+    processor->prepareToPlay(48000.0, numSamples);
+  setParameter(midSide, zldsp::midSide::ID, 1.f);
+  setParameter(midSide, zldsp::sideWet::ID, 0.f);
+
+  juce::AudioBuffer<float> stereoBuffer(2, numSamples), midSideBuffer(2, numSamples);
+  juce::MidiBuffer midi;
+  auto fill = [&](juce::AudioBuffer<float>& buffer, int block, float rightSign) {
+    for (int i = 0; i < numSamples; ++i)
+    {
+      const auto x = 0.9f * std::sin(0.05f * static_cast<float>(block * numSamples + i));
+      buffer.setSample(0, i, x);
+      buffer.setSample(1, i, rightSign * x);
+    }
+  };
+
+  // identical channels have no side, so the mid is shaped exactly like each stereo channel
+  for (int block = 0; block < 8; ++block)
+  {
+    fill(stereoBuffer, block, 1.f);
+    fill(midSideBuffer, block, 1.f);
+    stereo.processBlock(stereoBuffer, midi);
+    midSide.processBlock(midSideBuffer, midi);
+    for (int ch = 0; ch < 2; ++ch)
+      for (int i = 0; i < numSamples; ++i)
+        CHECK(std::abs(midSideBuffer.getSample(ch, i) - stereoBuffer.getSample(ch, i)) < 1e-5f);
+  }
+
+  // opposite channels are all side, which is left dry
+  for (int block = 0; block < 8; ++block)
+  {
+    fill(midSideBuffer, block, -1.f);
+    midSide.processBlock(midSideBuffer, midi);
+    for (int i = 0; i < numSamples; ++i)
+    {
+      const auto x = 0.9f * std::sin(0.05f * static_cast<float>(block * numSamples + i));
+      CHECK(std::abs(midSideBuffer.getSample(0, i) - x) < 1e-5f);
+      CHECK(std::abs(midSideBuffer.getSample(1, i) + x) < 1e-5f);
+    }
+  }
+}
+
+TEST_CASE("Stage timing reports the load of the stages it runs", "[load]")
+{
+  ZLInflatorAudioProcessor processor;
+  processor.prepareToPlay(48000.0, 512);
+  setParameter(processor, zldsp::bandSplit::ID, 1.f);
+  setParameter(processor, zldsp::overSample::ID, 2.f);
+  auto& stageLoad = processor.getStageLoad();
+
+  render(processor, 4);
+  CHECK(stageLoad.getTotalLoad() == 0.f);
+
+  stageLoad.setEnabled(true);
+  render(processor, 8);
+  for (auto stage : {zldsp::StageLoad::upSampling, zldsp::StageLoad::crossover, zldsp::StageLoad::shaper, zldsp::StageLoad::downSampling})
+  {
+    INFO(zldsp::StageLoad::names[stage]);
+    CHECK(stageLoad.getLoad(stage) > 0.f);
+  }
+  CHECK(stageLoad.getTotalLoad() > stageLoad.getLoad(zldsp::StageLoad::crossover));
+}
+
+TEST_CASE("Only the shapers of the prepared precision and channels are created", "[memory]")
+{
+  ZLInflatorAudioProcessor stereo, surround;
+  CHECK(stereo.getMemoryUsage() == sizeof(ZLInflatorAudioProcessor));
+
+  juce::AudioProcessor::BusesLayout layout;
+  layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(8));
+  layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(8));
+  REQUIRE(surround.setBusesLayout(layout));
+  stereo.prepareToPlay(48000.0, 512);
+  surround.prepareToPlay(48000.0, 512);
+  const auto stereoMemory = stereo.getMemoryUsage();
+  // four pairs, and the linked shaper without oversamplers while channel link is off
+  CHECK(surround.getMemoryUsage() > 4 * (stereoMemory - sizeof(ZLInflatorAudioProcessor)));
+
+  // switching the precision frees the float shapers
+  stereo.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+  stereo.prepareToPlay(48000.0, 512);
+  CHECK(stereo.getMemoryUsage() > stereoMemory);
+  stereo.setProcessingPrecision(juce::AudioProcessor::singlePrecision);
+  stereo.prepareToPlay(48000.0, 512);
+  CHECK(stereo.getMemoryUsage() == stereoMemory);
+}
+
+TEST_CASE("The linked shaper holds oversamplers only while channel link is on", "[memory]")
+{
+  constexpr int numChannels = 8, numSamples = 512;
+  ZLInflatorAudioProcessor processor;
+  juce::AudioProcessor::BusesLayout layout;
+  layout.inputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+  layout.outputBuses.add(juce::AudioChannelSet::discreteChannels(numChannels));
+  REQUIRE(processor.setBusesLayout(layout));
+  setParameter(processor, zldsp::overSample::ID, 2.f);
+  processor.prepareToPlay(48000.0, numSamples);
+
+  juce::AudioBuffer<float> buffer(numChannels, numSamples);
+  juce::MidiBuffer midi;
+  auto renderBlock = [&]() {
+    for (int ch = 0; ch < numChannels; ++ch)
+      for (int i = 0; i < numSamples; ++i)
+        buffer.setSample(ch, i, 0.5f * std::sin(0.02f * static_cast<float>(i + ch)));
+    processor.processBlock(buffer, midi);
+  };
+
+  renderBlock();
+  const auto unlinkedMemory = processor.getMemoryUsage();
+
+  // the 4x stage buffers of every channel: 2 + 4 block sizes
+  setParameter(processor, zldsp::channelLink::ID, 1.f);
+  renderBlock();
+  CHECK(processor.getMemoryUsage() >= unlinkedMemory + numChannels * numSamples * 6 * sizeof(float));
+
+  // once the audio thread has let go of it, the linked oversampler is freed
+  setParameter(processor, zldsp::channelLink::ID, 0.f);
+  renderBlock();
+  CHECK(processor.getMemoryUsage() == unlinkedMemory);
+}
+
+TEST_CASE("Lookup table mode matches the analytic shaper", "[table]")
+{
+  constexpr int numSamples = 512;
+  ZLInflatorAudioProcessor analytic, table;
+  for (auto* processor : {&analytic, &table})
+  {
+    processor->prepareToPlay(48000.0, numSamples);
+    setParameter(*processor, zldsp::style1::ID, static_cast<float>(zldsp::style1::SinMOD));
+    setParameter(*processor, zldsp::style2::ID, static_cast<float>(zldsp::style2::Quartic));
+  }
+  setParameter(table, zldsp::lookupTable::ID, 1.f);
+
+  juce::AudioBuffer<float> analyticBuffer(2, numSamples), tableBuffer(2, numSamples);
+  juce::MidiBuffer midi;
+  for (int block = 0; block < 24; ++block)
+  {
+    // the table jumps to a new curve while the analytic shaper ramps, so the ramp is left out
+    if (block == 8)
+      for (auto* processor : {&analytic, &table})
+        setParameter(*processor, zldsp::curve1::ID, 80.f);
+    for (auto* buffer : {&analyticBuffer, &tableBuffer})
+      for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numSamples; ++i)
+          buffer->setSample(ch, i, 0.9f * std::sin(0.02f * static_cast<float>(block * numSamples + i) + 0.5f * static_cast<float>(ch)));
+    analytic.processBlock(analyticBuffer, midi);
+    table.processBlock(tableBuffer, midi);
+    if (block >= 8 && block < 14)
+      continue;
+
+    float maxError = 0.f;
+    for (int ch = 0; ch < 2; ++ch)
+      for (int i = 0; i < numSamples; ++i)
+        maxError = std::max(maxError, std::abs(tableBuffer.getSample(ch, i) - analyticBuffer.getSample(ch, i)));
+    CHECK(maxError < 1e-5f);
+  }
+}
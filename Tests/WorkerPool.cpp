@@ -0,0 +1,27 @@
+#include <DSP/WorkerPool.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("WorkerPool runs every job of a run exactly once", "[workers]")
+{
+  zldsp::WorkerPool pool;
+  pool.setNumWorkers(3, 512, 48000.0);
+
+  // runs of every size back to back, some jobs slow, so that workers wake late and overlap the next run
+  std::array<std::atomic<int>, 9> hits{};
+  bool ok = true;
+  for (int run = 0; run < 20000 && ok; ++run)
+  {
+    const auto numJobs = static_cast<size_t>(1 + run % 9);
+    for (auto& hit : hits)
+      hit.store(0);
+    auto job = [&](size_t index) {
+      hits[index].fetch_add(1);
+      if ((index + static_cast<size_t>(run)) % 7 == 0)
+        juce::Thread::yield();
+    };
+    pool.run(numJobs, job);
+    for (size_t i = 0; i < hits.size(); ++i)
+      ok = ok && hits[i].load() == (i < numJobs ? 1 : 0);
+  }
+  CHECK(ok);
+}